@@ -0,0 +1,82 @@
+#include <cmath>
+#include <ctime>
+#include "Builtin.h"
+#include "Object.h"
+
+Builtin::Builtin()
+{
+    Register("length", 1, [](const NativeArgument& _argument, std::any& _anyResult) {
+        if (_argument.size() == 1 && Object::IsArray(_argument[0])) {
+            _anyResult = static_cast<float64>(Object::ToArray(_argument[0])->m_vecValue.size());
+        }
+        else if (_argument.size() == 1 && Object::IsMap(_argument[0])) {
+            _anyResult = static_cast<float64>(Object::ToMap(_argument[0])->m_mapValue.size());
+        }
+        else {
+            _anyResult = 0.0;
+        }
+    });
+    Register("push", 2, [](const NativeArgument& _argument, std::any& _anyResult) {
+        if (_argument.size() == 2 && Object::IsArray(_argument[0])) {
+            Object::ToArray(_argument[0])->m_vecValue.push_back(_argument[1]);
+            _anyResult = _argument[0];
+        }
+        else {
+            _anyResult = nullptr;
+        }
+    });
+    Register("pop", 1, [](const NativeArgument& _argument, std::any& _anyResult) {
+        if (_argument.size() == 1 && Object::IsArray(_argument[0]) && Object::ToArray(_argument[0])->m_vecValue.size() != 0) {
+            auto pArray = Object::ToArray(_argument[0]);
+            _anyResult = std::move(pArray->m_vecValue.back());
+            pArray->m_vecValue.pop_back();
+        }
+        else {
+            _anyResult = nullptr;
+        }
+    });
+    Register("erase", 2, [](const NativeArgument& _argument, std::any& _anyResult) {
+        if (_argument.size() == 2 && Object::IsMap(_argument[0]) && Object::IsString(_argument[1]) &&
+            Object::ToMap(_argument[0])->m_mapValue.count(Object::ToString(_argument[1]))) {
+            auto pMap = Object::ToMap(_argument[0]);
+            auto key = Object::ToString(_argument[1]);
+            _anyResult = pMap->m_mapValue.at(key);
+            pMap->m_mapValue.erase(key);
+        }
+        else {
+            _anyResult = nullptr;
+        }
+    });
+    Register("clock", 0, [](const NativeArgument& _argument, std::any& _anyResult) {
+        _anyResult = static_cast<float64>(clock());
+    });
+    Register("sqrt", 1, [](const NativeArgument& _argument, std::any& _anyResult) {
+        if (_argument.size() != 0 && Object::IsNumber(_argument[0])) {
+            _anyResult = std::sqrt(static_cast<float64>(Object::ToNumber(_argument[0])));
+        }
+        else if (_argument.size() != 0 && Object::IsFloat(_argument[0])) {
+            _anyResult = std::sqrt(Object::ToFloat(_argument[0]));
+        }
+        else {
+            _anyResult = 0.0;
+        }
+    });
+}
+
+uint64 Builtin::Register(const std::string& _strName, uint64 _arity, NativeFunction _function)
+{
+    auto findIt = m_mapIndex.find(_strName);
+    if (findIt != m_mapIndex.end()) {
+        m_vecEntry[findIt->second] = { _strName, _arity, _function };
+        return findIt->second;
+    }
+    m_vecEntry.push_back({ _strName, _arity, _function });
+    m_mapIndex[_strName] = m_vecEntry.size() - 1;
+    return m_vecEntry.size() - 1;
+}
+
+uint64 Builtin::Find(const std::string& _strName) const
+{
+    auto findIt = m_mapIndex.find(_strName);
+    return findIt != m_mapIndex.end() ? findIt->second : SIZE_MAX;
+}
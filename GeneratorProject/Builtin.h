@@ -0,0 +1,63 @@
+#pragma once
+
+#include <any>
+#include <map>
+#include <vector>
+#include <string>
+#include "TypeDefine.h"
+
+// Arguments of a native call left where the caller keeps them. The operand stack has them
+// pushed in reverse, so a view from its top walks down with a step of -1
+class NativeArgument
+{
+public:
+	NativeArgument(std::any* _pFirst, uint64 _count, int64 _step = 1) : m_pFirst(_pFirst), m_iCount(_count), m_iStep(_step) { }
+
+	std::any& operator[](uint64 _index) const { return m_pFirst[static_cast<int64>(_index) * m_iStep]; }
+	uint64 size() const { return m_iCount; }
+
+private:
+	std::any* m_pFirst;
+	uint64 m_iCount;
+	int64 m_iStep;
+};
+
+// Writes the result of the call into _anyResult, nothing is allocated for the arguments
+using NativeFunction = void(*)(const NativeArgument& _argument, std::any& _anyResult);
+
+struct NativeEntry
+{
+public:
+	std::string m_strName;
+	// Argument count a call is linked to CallNative for, other counts go through the generic Call
+	uint64 m_iArity = 0;
+	NativeFunction m_function = nullptr;
+};
+
+// The one table of builtins the Interpreter, closures, Machine and RegisterMachine all call through.
+// A name keeps its index once registered, Generate links calls to it as CallNative with that index.
+// Shared by every thread, so Register belongs before any of them start compiling or running
+class Builtin
+{
+private:
+	Builtin();
+	~Builtin() { }
+public:
+	static Builtin& GetInstance()
+	{
+		static Builtin instance;
+		return instance;
+	}
+#define BuiltinMgr		Builtin::GetInstance()
+
+public:
+	// Adds the builtin or replaces the one with the same name
+	uint64 Register(const std::string& _strName, uint64 _arity, NativeFunction _function);
+	// SIZE_MAX when there is none
+	uint64 Find(const std::string& _strName) const;
+	const NativeEntry& Get(uint64 _index) const { return m_vecEntry[_index]; }
+
+private:
+	std::vector<NativeEntry> m_vecEntry;
+	std::map<std::string, uint64> m_mapIndex;
+};
@@ -0,0 +1,97 @@
+#include <map>
+#include "CallGraph.h"
+
+void CallGraph::Prune(std::shared_ptr<Program> _pProgram)
+{
+    m_vecRemoved.clear();
+    m_setAssigned.clear();
+    m_setReferenced.clear();
+    m_vecWork.clear();
+
+    std::map<std::string, std::shared_ptr<Function>> mapFunction;
+    std::map<std::string, std::shared_ptr<Class>> mapClass;
+    for (auto& pFunction : _pProgram->m_vecFunction) {
+        mapFunction[pFunction->m_strName] = pFunction;
+    }
+    for (auto& pClass : _pProgram->m_vecClass) {
+        mapClass[pClass->m_strName] = pClass;
+    }
+    if (mapFunction.count("main") == 0) {
+        return;
+    }
+
+    // Worklist over names, a body is walked the first time its name is mentioned
+    m_setReferenced.insert("main");
+    m_vecWork = { "main" };
+    while (m_vecWork.empty() == false) {
+        std::string strName = std::move(m_vecWork.back());
+        m_vecWork.pop_back();
+        if (auto findIt = mapFunction.find(strName); findIt != mapFunction.end()) {
+            for (auto& pNode : findIt->second->m_vecBlock) {
+                VisitStatement(pNode);
+            }
+        }
+        else if (auto findIt = mapClass.find(strName); findIt != mapClass.end()) {
+            VisitStatement(findIt->second);
+        }
+    }
+
+    auto isRemoved = [this](const std::string& _strName) {
+        if (m_setReferenced.count(_strName)) {
+            return false;
+        }
+        m_vecRemoved.push_back(_strName);
+        return true;
+    };
+    std::erase_if(_pProgram->m_vecClass, [&](std::shared_ptr<Class>& _pClass) { return isRemoved(_pClass->m_strName); });
+    std::erase_if(_pProgram->m_vecFunction, [&](std::shared_ptr<Function>& _pFunction) { return isRemoved(_pFunction->m_strName); });
+}
+
+void CallGraph::CollectAssigned(std::shared_ptr<Program> _pProgram)
+{
+    m_setAssigned.clear();
+    m_setReferenced.clear();
+    m_vecWork.clear();
+    for (auto& pFunction : _pProgram->m_vecFunction) {
+        for (auto& pNode : pFunction->m_vecBlock) {
+            VisitStatement(pNode);
+        }
+    }
+    for (auto& pClass : _pProgram->m_vecClass) {
+        VisitStatement(pClass);
+    }
+}
+
+std::string CallGraph::PrintReport()
+{
+    std::string strResult;
+    for (auto& strName : m_vecRemoved) {
+        strResult += strName + " : unreachable, removed\n";
+    }
+    return strResult;
+}
+
+void CallGraph::VisitStatement(const std::shared_ptr<Statement>& _pStatement)
+{
+    _pStatement->ForEachChild({
+        [this](const std::shared_ptr<Statement>& _pChild) { VisitStatement(_pChild); },
+        [this](const std::shared_ptr<Expression>& _pChild) { VisitExpression(_pChild); },
+    });
+}
+
+void CallGraph::VisitExpression(const std::shared_ptr<Expression>& _pExpression)
+{
+    // Locals shadowing a function name keep it alive too, a cheap and safe over-approximation
+    if (auto pGetVariable = std::dynamic_pointer_cast<GetVariable>(_pExpression)) {
+        if (m_setReferenced.insert(pGetVariable->m_strName).second) {
+            m_vecWork.push_back(pGetVariable->m_strName);
+        }
+    }
+    else if (auto pSetVariable = std::dynamic_pointer_cast<SetVariable>(_pExpression)) {
+        m_setAssigned.insert(pSetVariable->m_strName);
+    }
+    _pExpression->ForEachChild({
+        [this](const std::shared_ptr<Statement>& _pChild) { VisitStatement(_pChild); },
+        [this](const std::shared_ptr<Expression>& _pChild) { VisitExpression(_pChild); },
+    });
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <set>
+#include <vector>
+#include <memory>
+#include <string>
+#include "TypeDefine.h"
+#include "Node.h"
+
+// Drops the functions and classes main can never reach before Generate,
+// any mention of a name counts as a use so functions passed around as values are kept
+class CallGraph
+{
+private:
+	CallGraph() { }
+	~CallGraph() { }
+public:
+	static CallGraph& GetInstance()
+	{
+		static thread_local CallGraph instance;
+		return instance;
+	}
+#define CallGraphMgr		CallGraph::GetInstance()
+
+public:
+	void Prune(std::shared_ptr<Program> _pProgram);
+	// Fills m_setAssigned from every function and class of the program, nothing is removed
+	void CollectAssigned(std::shared_ptr<Program> _pProgram);
+	std::string PrintReport();
+
+private:
+	void VisitStatement(const std::shared_ptr<Statement>& _pStatement);
+	void VisitExpression(const std::shared_ptr<Expression>& _pExpression);
+
+public:
+	// Names removed by the last Prune, in source order
+	std::vector<std::string> m_vecRemoved;
+	// Names the reachable code assigns to, locals included, so a builtin name in it may hold anything at runtime
+	std::set<std::string> m_setAssigned;
+
+private:
+	// Per Prune : names mentioned by the reachable code so far, and those whose body is not walked yet
+	std::set<std::string> m_setReferenced;
+	std::vector<std::string> m_vecWork;
+};
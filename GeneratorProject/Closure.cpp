@@ -0,0 +1,735 @@
+#include <cmath>
+#include "Closure.h"
+#include "Object.h"
+
+#include "Application.h"
+
+namespace
+{
+    template<typename T>
+    bool Is(const std::any& _anyValue)
+    {
+        return _anyValue.type() == typeid(T);
+    }
+
+    template<typename T>
+    const T& As(const std::any& _anyValue)
+    {
+        return *std::any_cast<T>(&_anyValue);
+    }
+
+    bool IsTrue(const std::any& _anyValue)
+    {
+        return Is<bool>(_anyValue) && As<bool>(_anyValue);
+    }
+
+    bool IsFalse(const std::any& _anyValue)
+    {
+        return Is<bool>(_anyValue) && As<bool>(_anyValue) == false;
+    }
+
+    enum class EOperandShape
+    {
+        Local,
+        Constant,
+        General,
+    };
+
+    struct ClosureOperand
+    {
+        EOperandShape m_eShape = EOperandShape::General;
+        uint64 m_iSlot = 0;
+        std::any m_anyConstant;
+        ExpressionClosure m_closure;
+    };
+
+    ClosureOperand ToOperand(std::shared_ptr<Expression> _pExpression)
+    {
+        ClosureOperand operand;
+        if (auto pGetVariable = std::dynamic_pointer_cast<GetVariable>(_pExpression)) {
+            uint64 slot = ClosureCompilerMgr.GetLocal(pGetVariable->m_strName);
+            if (slot != SIZE_MAX) {
+                operand.m_eShape = EOperandShape::Local;
+                operand.m_iSlot = slot;
+                return operand;
+            }
+        }
+        if (std::dynamic_pointer_cast<NullLiteral>(_pExpression) ||
+            std::dynamic_pointer_cast<BooleanLiteral>(_pExpression) ||
+            std::dynamic_pointer_cast<NumberLiteral>(_pExpression) ||
+            std::dynamic_pointer_cast<FloatLiteral>(_pExpression) ||
+            std::dynamic_pointer_cast<StringLiteral>(_pExpression)) {
+            operand.m_eShape = EOperandShape::Constant;
+            operand.m_anyConstant = _pExpression->Interpret();
+            return operand;
+        }
+        operand.m_closure = _pExpression->Compile();
+        return operand;
+    }
+
+    // One closure per operand shape so the shape is never inspected again at run time
+    template<OperatorKernel Operate>
+    ExpressionClosure BindBinary(const ClosureOperand& _lhs, const ClosureOperand& _rhs)
+    {
+        switch (_lhs.m_eShape) {
+        case EOperandShape::Local: {
+            uint64 lSlot = _lhs.m_iSlot;
+            switch (_rhs.m_eShape) {
+            case EOperandShape::Local:
+                return [lSlot, rSlot = _rhs.m_iSlot](ClosureFrame& _frame) -> std::any {
+                    return Operate(_frame.m_vecVariable[lSlot], _frame.m_vecVariable[rSlot]);
+                };
+            case EOperandShape::Constant:
+                return [lSlot, rConstant = _rhs.m_anyConstant](ClosureFrame& _frame) -> std::any {
+                    return Operate(_frame.m_vecVariable[lSlot], rConstant);
+                };
+            default:
+                return [lSlot, rClosure = _rhs.m_closure](ClosureFrame& _frame) -> std::any {
+                    std::any lValue = _frame.m_vecVariable[lSlot];
+                    return Operate(lValue, rClosure(_frame));
+                };
+            }
+        }
+        case EOperandShape::Constant: {
+            const std::any& lConstant = _lhs.m_anyConstant;
+            switch (_rhs.m_eShape) {
+            case EOperandShape::Local:
+                return [lConstant, rSlot = _rhs.m_iSlot](ClosureFrame& _frame) -> std::any {
+                    return Operate(lConstant, _frame.m_vecVariable[rSlot]);
+                };
+            case EOperandShape::Constant:
+                return [lConstant, rConstant = _rhs.m_anyConstant](ClosureFrame& _frame) -> std::any {
+                    return Operate(lConstant, rConstant);
+                };
+            default:
+                return [lConstant, rClosure = _rhs.m_closure](ClosureFrame& _frame) -> std::any {
+                    return Operate(lConstant, rClosure(_frame));
+                };
+            }
+        }
+        default: {
+            const ExpressionClosure& lClosure = _lhs.m_closure;
+            switch (_rhs.m_eShape) {
+            case EOperandShape::Local:
+                return [lClosure, rSlot = _rhs.m_iSlot](ClosureFrame& _frame) -> std::any {
+                    std::any lValue = lClosure(_frame);
+                    return Operate(lValue, _frame.m_vecVariable[rSlot]);
+                };
+            case EOperandShape::Constant:
+                return [lClosure, rConstant = _rhs.m_anyConstant](ClosureFrame& _frame) -> std::any {
+                    return Operate(lClosure(_frame), rConstant);
+                };
+            default:
+                return [lClosure, rClosure = _rhs.m_closure](ClosureFrame& _frame) -> std::any {
+                    std::any lValue = lClosure(_frame);
+                    std::any rValue = rClosure(_frame);
+                    return Operate(lValue, rValue);
+                };
+            }
+        }
+        }
+    }
+
+    ExpressionClosure BindOperator(EOperator _eOperator, const ClosureOperand& _lhs, const ClosureOperand& _rhs)
+    {
+        switch (_eOperator) {
+        case EOperator::Add:            return BindBinary<&Operate<EOperator::Add>>(_lhs, _rhs);
+        case EOperator::Subtract:       return BindBinary<&Operate<EOperator::Subtract>>(_lhs, _rhs);
+        case EOperator::Multiply:       return BindBinary<&Operate<EOperator::Multiply>>(_lhs, _rhs);
+        case EOperator::Divide:         return BindBinary<&Operate<EOperator::Divide>>(_lhs, _rhs);
+        case EOperator::Modulo:         return BindBinary<&Operate<EOperator::Modulo>>(_lhs, _rhs);
+        case EOperator::Equal:          return BindBinary<&Operate<EOperator::Equal>>(_lhs, _rhs);
+        case EOperator::NotEqual:       return BindBinary<&Operate<EOperator::NotEqual>>(_lhs, _rhs);
+        case EOperator::LessThan:       return BindBinary<&Operate<EOperator::LessThan>>(_lhs, _rhs);
+        case EOperator::GreaterThan:    return BindBinary<&Operate<EOperator::GreaterThan>>(_lhs, _rhs);
+        case EOperator::LessOrEqual:    return BindBinary<&Operate<EOperator::LessOrEqual>>(_lhs, _rhs);
+        default:                        return BindBinary<&Operate<EOperator::GreaterOrEqual>>(_lhs, _rhs);
+        }
+    }
+
+    std::vector<ExpressionClosure> CompileArgument(std::vector<std::shared_ptr<Expression>>& _vecArgument)
+    {
+        std::vector<ExpressionClosure> vecResult;
+        vecResult.reserve(_vecArgument.size());
+        for (auto& pNode : _vecArgument) {
+            vecResult.push_back(pNode->Compile());
+        }
+        return vecResult;
+    }
+}
+
+void ClosureCompiler::Compile(std::shared_ptr<Program> _pProgram)
+{
+    m_mapFunction.clear();
+    m_mapFunctionTable.clear();
+    for (auto& pNode : _pProgram->m_vecFunction) {
+        auto pFunction = std::make_shared<ClosureFunction>();
+        pFunction->m_pFunction = pNode;
+        m_mapFunction[pNode.get()] = pFunction;
+        m_mapFunctionTable[pNode->m_strName] = pFunction.get();
+    }
+    for (auto& pNode : _pProgram->m_vecFunction) {
+        pNode->Compile();
+    }
+}
+
+std::any ClosureCompiler::Run(std::string _strName)
+{
+    auto findIt = m_mapFunctionTable.find(_strName);
+    if (findIt == m_mapFunctionTable.end()) {
+        return nullptr;
+    }
+    m_strOutput.clear();
+    ClosureFrame frame;
+    return Invoke(findIt->second, {}, frame);
+}
+
+ClosureFunction* ClosureCompiler::FindFunction(Function* _pFunction)
+{
+    auto findIt = m_mapFunction.find(_pFunction);
+    if (findIt == m_mapFunction.end()) {
+        return nullptr;
+    }
+    return findIt->second.get();
+}
+
+std::any ClosureCompiler::Invoke(ClosureFunction* _pFunction, const std::vector<ExpressionClosure>& _vecArgument, ClosureFrame& _frame)
+{
+    uint64 parameterSize = _pFunction->m_pFunction->m_vecParameter.size();
+    ClosureFrame frame;
+    frame.m_vecVariable.resize(max(_pFunction->m_iLocalSize, parameterSize));
+    for (uint64 i = 0; i < _vecArgument.size(); ++i) {
+        std::any value = _vecArgument[i](_frame);
+        if (i < parameterSize) {
+            frame.m_vecVariable[i] = std::move(value);
+        }
+    }
+    for (uint64 i = _vecArgument.size(); i < parameterSize; ++i) {
+        frame.m_vecVariable[i] = nullptr;
+    }
+    for (auto& statement : _pFunction->m_vecBlock) {
+        EFlow flow = statement(frame);
+        if (flow == EFlow::Return) {
+            return std::move(frame.m_anyReturn);
+        }
+        if (flow != EFlow::Normal) {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+std::any ClosureCompiler::InvokeValue(const std::any& _anyCallee, const std::vector<ExpressionClosure>& _vecArgument, ClosureFrame& _frame)
+{
+    if (Is<NativeFunction>(_anyCallee)) {
+        std::vector<std::any> values;
+        values.reserve(_vecArgument.size());
+        for (auto& argument : _vecArgument) {
+            values.push_back(argument(_frame));
+        }
+        std::any result;
+        As<NativeFunction>(_anyCallee)(NativeArgument(values.data(), values.size()), result);
+        return result;
+    }
+    if (Is<std::shared_ptr<Function>>(_anyCallee)) {
+        ClosureFunction* pFunction = ClosureCompilerMgr.FindFunction(As<std::shared_ptr<Function>>(_anyCallee).get());
+        if (pFunction) {
+            return Invoke(pFunction, _vecArgument, _frame);
+        }
+    }
+    return nullptr;
+}
+
+StatementClosure ClosureCompiler::CompileBlock(std::vector<std::shared_ptr<Statement>>& _vecBlock)
+{
+    std::vector<StatementClosure> vecBlock;
+    vecBlock.reserve(_vecBlock.size());
+    for (auto& pNode : _vecBlock) {
+        vecBlock.push_back(pNode->Compile());
+    }
+    return [vecBlock](ClosureFrame& _frame) {
+        for (auto& statement : vecBlock) {
+            EFlow flow = statement(_frame);
+            if (flow != EFlow::Normal) {
+                return flow;
+            }
+        }
+        return EFlow::Normal;
+    };
+}
+
+void ClosureCompiler::SetLocal(std::string _strLocal)
+{
+    m_listSymbolStackTable.front()[_strLocal] = m_vecOffsetStack.back();
+    m_vecOffsetStack.back() += 1;
+    m_iLocalSize = max(m_iLocalSize, m_vecOffsetStack.back());
+}
+
+uint64 ClosureCompiler::GetLocal(std::string _strLocal)
+{
+    for (auto& symbolTable : m_listSymbolStackTable) {
+        if (symbolTable.count(_strLocal)) {
+            return symbolTable[_strLocal];
+        }
+    }
+    return SIZE_MAX;
+}
+
+void ClosureCompiler::InitBlock()
+{
+    m_iLocalSize = 0;
+    m_vecOffsetStack.push_back(0);
+    m_listSymbolStackTable.emplace_front();
+}
+
+void ClosureCompiler::PushBlock()
+{
+    m_listSymbolStackTable.emplace_front();
+    m_vecOffsetStack.push_back(m_vecOffsetStack.back());
+}
+
+void ClosureCompiler::PopBlock()
+{
+    m_vecOffsetStack.pop_back();
+    m_listSymbolStackTable.pop_front();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Function
+StatementClosure Function::Compile()
+{
+    ClosureFunction* pFunction = ClosureCompilerMgr.FindFunction(this);
+    ClosureCompilerMgr.InitBlock();
+    for (std::string& paramName : m_vecParameter) {
+        ClosureCompilerMgr.SetLocal(paramName);
+    }
+    for (auto& pNode : m_vecBlock) {
+        pFunction->m_vecBlock.push_back(pNode->Compile());
+    }
+    ClosureCompilerMgr.PopBlock();
+    pFunction->m_iLocalSize = ClosureCompilerMgr.m_iLocalSize;
+
+    return [pFunction](ClosureFrame& _frame) {
+        for (auto& statement : pFunction->m_vecBlock) {
+            EFlow flow = statement(_frame);
+            if (flow != EFlow::Normal) {
+                return flow;
+            }
+        }
+        return EFlow::Normal;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - For
+StatementClosure For::Compile()
+{
+    ClosureCompilerMgr.PushBlock();
+    auto variable = m_pVariable->Compile();
+    auto condition = m_pCondition->Compile();
+    auto expression = m_pExpression->Compile();
+    auto block = ClosureCompilerMgr.CompileBlock(m_vecBlock);
+    ClosureCompilerMgr.PopBlock();
+
+    return [variable, condition, expression, block](ClosureFrame& _frame) {
+        variable(_frame);
+        while (IsTrue(condition(_frame))) {
+            EFlow flow = block(_frame);
+            if (flow == EFlow::Break) {
+                break;
+            }
+            if (flow == EFlow::Return) {
+                return flow;
+            }
+            expression(_frame);
+        }
+        return EFlow::Normal;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - If
+StatementClosure If::Compile()
+{
+    std::vector<ExpressionClosure> vecCondition;
+    std::vector<StatementClosure> vecBlock;
+    for (uint64 i = 0; i < m_vecCondition.size(); ++i) {
+        vecCondition.push_back(m_vecCondition[i]->Compile());
+        ClosureCompilerMgr.PushBlock();
+        vecBlock.push_back(ClosureCompilerMgr.CompileBlock(m_vecBlocks[i]));
+        ClosureCompilerMgr.PopBlock();
+    }
+    ClosureCompilerMgr.PushBlock();
+    auto elseBlock = ClosureCompilerMgr.CompileBlock(m_vecElseBlock);
+    ClosureCompilerMgr.PopBlock();
+
+    if (vecCondition.size() == 1) {
+        return [condition = vecCondition[0], block = vecBlock[0], elseBlock](ClosureFrame& _frame) {
+            return IsTrue(condition(_frame)) ? block(_frame) : elseBlock(_frame);
+        };
+    }
+    return [vecCondition, vecBlock, elseBlock](ClosureFrame& _frame) {
+        for (uint64 i = 0; i < vecCondition.size(); ++i) {
+            if (IsTrue(vecCondition[i](_frame))) {
+                return vecBlock[i](_frame);
+            }
+        }
+        return elseBlock(_frame);
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Variable
+StatementClosure Variable::Compile()
+{
+    ClosureCompilerMgr.SetLocal(m_strName);
+    uint64 slot = ClosureCompilerMgr.GetLocal(m_strName);
+    auto expression = m_pExpression->Compile();
+    return [slot, expression](ClosureFrame& _frame) {
+        _frame.m_vecVariable[slot] = expression(_frame);
+        return EFlow::Normal;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Print
+StatementClosure Print::Compile()
+{
+    std::vector<ExpressionClosure> vecArgument = CompileArgument(m_vecArgument);
+    bool bLineFeed = m_bLineFeed;
+    return [vecArgument, bLineFeed](ClosureFrame& _frame) {
+        for (auto& argument : vecArgument) {
+            ClosureCompilerMgr.m_strOutput += AnyToString(argument(_frame));
+        }
+        if (bLineFeed) {
+            ClosureCompilerMgr.m_strOutput += '\n';
+        }
+        return EFlow::Normal;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Return
+StatementClosure Return::Compile()
+{
+    auto expression = m_pExpression->Compile();
+    return [expression](ClosureFrame& _frame) {
+        _frame.m_anyReturn = expression(_frame);
+        return EFlow::Return;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Break
+StatementClosure Break::Compile()
+{
+    return [](ClosureFrame& _frame) {
+        return EFlow::Break;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Continue
+StatementClosure Continue::Compile()
+{
+    return [](ClosureFrame& _frame) {
+        return EFlow::Continue;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - ExpressionStatement
+StatementClosure ExpressionStatement::Compile()
+{
+    auto expression = m_pExpression->Compile();
+    return [expression](ClosureFrame& _frame) {
+        expression(_frame);
+        return EFlow::Normal;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Or
+ExpressionClosure Or::Compile()
+{
+    auto lhs = m_pLhs->Compile();
+    auto rhs = m_pRhs->Compile();
+    return [lhs, rhs](ClosureFrame& _frame) -> std::any {
+        if (IsTrue(lhs(_frame))) {
+            return true;
+        }
+        return rhs(_frame);
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - And
+ExpressionClosure And::Compile()
+{
+    auto lhs = m_pLhs->Compile();
+    auto rhs = m_pRhs->Compile();
+    return [lhs, rhs](ClosureFrame& _frame) -> std::any {
+        if (IsFalse(lhs(_frame))) {
+            return false;
+        }
+        return rhs(_frame);
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Relational
+ExpressionClosure Relational::Compile()
+{
+    return BindOperator(ToOperator(m_eKind), ToOperand(m_pLhs), ToOperand(m_pRhs));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Arithmetic
+ExpressionClosure Arithmetic::Compile()
+{
+    return BindOperator(ToOperator(m_eKind), ToOperand(m_pLhs), ToOperand(m_pRhs));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Unary
+ExpressionClosure Unary::Compile()
+{
+    auto sub = m_pSub->Compile();
+    if (m_eKind == EKind::Add) {
+        return [sub](ClosureFrame& _frame) -> std::any {
+            auto value = sub(_frame);
+            if (Is<uint64>(value)) {
+                return As<uint64>(value);
+            }
+            return 0.0;
+        };
+    }
+    if (m_eKind == EKind::Subtract) {
+        return [sub](ClosureFrame& _frame) -> std::any {
+            auto value = sub(_frame);
+            if (Is<uint64>(value)) {
+                return As<uint64>(value) * -1;
+            }
+            return 0.0;
+        };
+    }
+    return [sub](ClosureFrame& _frame) -> std::any {
+        sub(_frame);
+        return 0.0;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - GetElement
+ExpressionClosure GetElement::Compile()
+{
+    auto sub = m_pSub->Compile();
+    auto index = m_pIndex->Compile();
+    return [sub, index](ClosureFrame& _frame) -> std::any {
+        auto object = sub(_frame);
+        auto anyIndex = index(_frame);
+        if (Object::IsArray(object) && Is<uint64>(anyIndex)) {
+            return Object::GetValueOfArray(object, anyIndex);
+        }
+        if (Object::IsMap(object) && Is<std::string>(anyIndex)) {
+            return Object::GetValueOfMap(object, anyIndex);
+        }
+        return nullptr;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SetElement
+ExpressionClosure SetElement::Compile()
+{
+    auto sub = m_pSub->Compile();
+    auto index = m_pIndex->Compile();
+    auto value = m_pValue->Compile();
+    return [sub, index, value](ClosureFrame& _frame) -> std::any {
+        auto object = sub(_frame);
+        auto anyIndex = index(_frame);
+        auto anyValue = value(_frame);
+        if (Object::IsArray(object) && Is<uint64>(anyIndex)) {
+            return Object::SetValueOfArray(object, anyIndex, anyValue);
+        }
+        if (Object::IsMap(object) && Is<std::string>(anyIndex)) {
+            return Object::SetValueOfMap(object, anyIndex, anyValue);
+        }
+        return nullptr;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Call
+ExpressionClosure Call::Compile()
+{
+    std::vector<ExpressionClosure> vecArgument = CompileArgument(m_vecArgument);
+
+    // Calls to a script function by name are bound now, a global of the same name still wins
+    auto pGetVariable = std::dynamic_pointer_cast<GetVariable>(m_pSub);
+    if (pGetVariable && ClosureCompilerMgr.GetLocal(pGetVariable->m_strName) == SIZE_MAX &&
+        ClosureCompilerMgr.m_mapFunctionTable.count(pGetVariable->m_strName)) {
+        ClosureFunction* pTarget = ClosureCompilerMgr.m_mapFunctionTable[pGetVariable->m_strName];
+        return [pTarget, strName = pGetVariable->m_strName, vecArgument](ClosureFrame& _frame) -> std::any {
+            auto& mapGlobal = InterpreterMgr.m_mapGlobal;
+            if (mapGlobal.empty() == false) {
+                auto findIt = mapGlobal.find(strName);
+                if (findIt != mapGlobal.end()) {
+                    return ClosureCompiler::InvokeValue(findIt->second, vecArgument, _frame);
+                }
+            }
+            return ClosureCompiler::Invoke(pTarget, vecArgument, _frame);
+        };
+    }
+
+    auto sub = m_pSub->Compile();
+    return [sub, vecArgument](ClosureFrame& _frame) -> std::any {
+        return ClosureCompiler::InvokeValue(sub(_frame), vecArgument, _frame);
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - NullLiteral
+ExpressionClosure NullLiteral::Compile()
+{
+    return [](ClosureFrame& _frame) -> std::any {
+        return nullptr;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - BooleanLiteral
+ExpressionClosure BooleanLiteral::Compile()
+{
+    return [bValue = m_bValue](ClosureFrame& _frame) -> std::any {
+        return bValue;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - NumberLiteral
+ExpressionClosure NumberLiteral::Compile()
+{
+    return [uValue = m_uValue](ClosureFrame& _frame) -> std::any {
+        return uValue;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - FloatLiteral
+ExpressionClosure FloatLiteral::Compile()
+{
+    return [dValue = m_dValue](ClosureFrame& _frame) -> std::any {
+        return dValue;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - StringLiteral
+ExpressionClosure StringLiteral::Compile()
+{
+    return [strValue = m_strValue](ClosureFrame& _frame) -> std::any {
+        return strValue;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - ArrayLiteral
+ExpressionClosure ArrayLiteral::Compile()
+{
+    std::vector<ExpressionClosure> vecValue = CompileArgument(m_vecValue);
+    return [vecValue](ClosureFrame& _frame) -> std::any {
+        auto result = std::make_shared<Array>();
+        result->m_vecValue.reserve(vecValue.size());
+        for (auto& value : vecValue) {
+            result->m_vecValue.push_back(value(_frame));
+        }
+        return result;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - MapLiteral
+ExpressionClosure MapLiteral::Compile()
+{
+    std::vector<std::tuple<std::string, ExpressionClosure>> vecValue;
+    for (auto& [key, pValue] : m_mapValue) {
+        vecValue.emplace_back(key, pValue->Compile());
+    }
+    return [vecValue](ClosureFrame& _frame) -> std::any {
+        auto result = std::make_shared<Map>();
+        for (auto& [key, value] : vecValue) {
+            result->m_mapValue.insert_or_assign(key, value(_frame));
+        }
+        return result;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - GetVariable
+ExpressionClosure GetVariable::Compile()
+{
+    uint64 slot = ClosureCompilerMgr.GetLocal(m_strName);
+    if (slot != SIZE_MAX) {
+        return [slot](ClosureFrame& _frame) -> std::any {
+            return _frame.m_vecVariable[slot];
+        };
+    }
+
+    std::any anyResolved = nullptr;
+    if (InterpreterMgr.m_mapFunctionTable.count(m_strName)) {
+        anyResolved = InterpreterMgr.m_mapFunctionTable[m_strName];
+    }
+    else if (uint64 native = BuiltinMgr.Find(m_strName); native != SIZE_MAX) {
+        anyResolved = BuiltinMgr.Get(native).m_function;
+    }
+    return [strName = m_strName, anyResolved](ClosureFrame& _frame) -> std::any {
+        auto& mapGlobal = InterpreterMgr.m_mapGlobal;
+        auto findIt = mapGlobal.find(strName);
+        if (findIt != mapGlobal.end()) {
+            return findIt->second;
+        }
+        return anyResolved;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SetVariable
+ExpressionClosure SetVariable::Compile()
+{
+    auto value = m_pValue->Compile();
+    uint64 slot = ClosureCompilerMgr.GetLocal(m_strName);
+    if (slot != SIZE_MAX) {
+        return [slot, value](ClosureFrame& _frame) -> std::any {
+            return _frame.m_vecVariable[slot] = value(_frame);
+        };
+    }
+    return [strName = m_strName, value](ClosureFrame& _frame) -> std::any {
+        return InterpreterMgr.m_mapGlobal[strName] = value(_frame);
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Class
+StatementClosure Class::Compile()
+{
+    return [](ClosureFrame& _frame) {
+        return EFlow::Normal;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SetClassAccess
+ExpressionClosure SetClassAccess::Compile()
+{
+    return [](ClosureFrame& _frame) -> std::any {
+        return 1;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - GetClassAccess
+ExpressionClosure GetClassAccess::Compile()
+{
+    return m_pSub->Compile();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <any>
+#include <map>
+#include <list>
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include "TypeDefine.h"
+#include "Node.h"
+
+// Statement closures report how control leaves them instead of throwing
+enum class EFlow
+{
+	Normal,
+	Break,
+	Continue,
+	Return,
+};
+
+struct ClosureFrame
+{
+public:
+	std::vector<std::any> m_vecVariable;
+	std::any m_anyReturn;
+};
+
+struct ClosureFunction
+{
+public:
+	std::shared_ptr<Function> m_pFunction;
+	uint64 m_iLocalSize = 0;
+	std::vector<StatementClosure> m_vecBlock;
+};
+
+// Converts the syntax tree into closures once, locals are resolved to frame slots
+class ClosureCompiler
+{
+private:
+	ClosureCompiler() { }
+	~ClosureCompiler() { }
+public:
+	static ClosureCompiler& GetInstance()
+	{
+		static thread_local ClosureCompiler instance;
+		return instance;
+	}
+#define ClosureCompilerMgr		ClosureCompiler::GetInstance()
+
+public:
+	void Compile(std::shared_ptr<Program> _pProgram);
+	std::any Run(std::string _strName);
+
+	ClosureFunction* FindFunction(Function* _pFunction);
+	static std::any Invoke(ClosureFunction* _pFunction, const std::vector<ExpressionClosure>& _vecArgument, ClosureFrame& _frame);
+	static std::any InvokeValue(const std::any& _anyCallee, const std::vector<ExpressionClosure>& _vecArgument, ClosureFrame& _frame);
+
+public:
+	StatementClosure CompileBlock(std::vector<std::shared_ptr<Statement>>& _vecBlock);
+	void SetLocal(std::string _strLocal);
+	uint64 GetLocal(std::string _strLocal);
+	void InitBlock();
+	void PushBlock();
+	void PopBlock();
+
+public:
+	std::map<Function*, std::shared_ptr<ClosureFunction>> m_mapFunction;
+	std::map<std::string, ClosureFunction*> m_mapFunctionTable;
+	std::list<std::map<std::string, uint64>> m_listSymbolStackTable;
+	std::vector<uint64> m_vecOffsetStack;
+	uint64 m_iLocalSize = 0;
+	// Text of Print since the last Run, shown by the UI thread as the Interpreter's
+	std::string m_strOutput;
+};
@@ -55,7 +55,7 @@ std::string ToString(Instruction _instruction)
 	return "";
 }
 
-std::string PrintCode(Code& _code)
+std::string PrintCode(const Code& _code)
 {
 	std::string strResult;
 	auto& type = _code.m_anyOperand.type();
@@ -79,7 +79,7 @@ std::string PrintCode(Code& _code)
 	}
 }
 
-std::ostream& operator<<(ostream& _stream, Code& _code)
+std::ostream& operator<<(ostream& _stream, const Code& _code)
 {
 	_stream << std::setw(15) << std::left << ToString(_code.m_instruction);
 	if (_code.m_anyOperand.type() == typeid(size_t)) {
@@ -11,13 +11,17 @@ using std::ostream;
 
 enum class Instruction {
 	Exit,
-	Call, Alloca, Return,
-	Jump, ConditionJump,
+	Call, TailCall, Alloca, Return,
+	// Operand : index of the builtin in Builtin, takes its arity from the operand stack
+	CallNative,
+	MemoLoad, MemoStore,
+	Jump, ConditionJump, LoopJump,
 	Print, PrintLine,
 
 	LogicalOr, LogicalAnd,
 	Add, Subtract,
 	Multiply, Divide, Modulo,
+	ShiftLeft,
 	Equal, NotEqual,
 	LessThan, GreaterThan,
 	LessOrEqual, GreaterOrEqual,
@@ -30,7 +34,20 @@ enum class Instruction {
 	PushNull, PushBoolean,
 	PushNumber, PushString,
 	PushArray, PushMap,
+	PushScopedArray, PushScopedMap,
 	PopOperand,
+
+	// Builtins called by name that no script function shadows, straight on the operand stack
+	ArrayLength, ArrayPush, ArrayPop, Sqrt,
+
+	// Operand types proven by TypeInference or seen by the profile,
+	// the number ones fall back to the generic path when a profiled guess turns out wrong
+	AddU64, SubtractU64, MultiplyU64,
+	EqualU64, NotEqualU64,
+	LessThanU64, GreaterThanU64,
+	LessOrEqualU64, GreaterOrEqualU64,
+	ConcatString,
+	GetElementArrayU64, SetElementArrayU64,
 };
 
 std::string ToString(Instruction _instruction);
@@ -38,7 +55,11 @@ std::string ToString(Instruction _instruction);
 struct Code {
 	Instruction m_instruction;
 	any m_anyOperand;
+	// Profile site the code was generated for, 0 for none
+	uint32 m_iSite = 0;
+	// Typed on a profile guess rather than a proof, so the Machine checks its operands
+	bool m_bSpeculative = false;
 };
 
-std::string PrintCode(Code& _code);
-std::ostream& operator<<(std::ostream& _os, Code& _code);
+std::string PrintCode(const Code& _code);
+std::ostream& operator<<(std::ostream& _os, const Code& _code);
@@ -0,0 +1,68 @@
+#include "Escape.h"
+
+void EscapeAnalysis::Clear()
+{
+    m_setScoped.clear();
+}
+
+void EscapeAnalysis::Analyze(std::shared_ptr<Function> _pFunction)
+{
+    m_setEscapedName.clear();
+    m_vecDeclared.clear();
+    // Parameters hold values from the caller, those stay on the GC list whatever their uses
+    m_setEscapedName.insert(_pFunction->m_vecParameter.begin(), _pFunction->m_vecParameter.end());
+    for (auto& pNode : _pFunction->m_vecBlock) {
+        VisitStatement(pNode);
+    }
+    // Variables are matched by name, every declaration of a name is covered by every use of it
+    for (auto& [name, pLiteral] : m_vecDeclared) {
+        if (m_setEscapedName.count(name) == 0) {
+            m_setScoped.insert(pLiteral);
+        }
+    }
+}
+
+bool EscapeAnalysis::IsScoped(const Expression* _pLiteral) const
+{
+    return m_setScoped.count(_pLiteral) != 0;
+}
+
+void EscapeAnalysis::VisitStatement(const std::shared_ptr<Statement>& _pStatement)
+{
+    Statement* pParent = _pStatement.get();
+    _pStatement->ForEachChild({
+        [this](const std::shared_ptr<Statement>& _pChild) { VisitStatement(_pChild); },
+        [this, pParent](const std::shared_ptr<Expression>& _pChild) { VisitExpression(_pChild, pParent, nullptr); },
+    });
+}
+
+void EscapeAnalysis::VisitExpression(const std::shared_ptr<Expression>& _pExpression, Statement* _pParentStatement, Expression* _pParentExpression)
+{
+    // Only the container of an element access does not hand the object on
+    auto isContainer = [&]() {
+        auto pGetElement = dynamic_cast<GetElement*>(_pParentExpression);
+        auto pSetElement = dynamic_cast<SetElement*>(_pParentExpression);
+        return (pGetElement && pGetElement->m_pSub == _pExpression) || (pSetElement && pSetElement->m_pSub == _pExpression);
+    };
+
+    if (auto pGetVariable = std::dynamic_pointer_cast<GetVariable>(_pExpression)) {
+        if (isContainer() == false) {
+            m_setEscapedName.insert(pGetVariable->m_strName);
+        }
+    }
+    else if (std::dynamic_pointer_cast<ArrayLiteral>(_pExpression) || std::dynamic_pointer_cast<MapLiteral>(_pExpression)) {
+        auto pVariable = dynamic_cast<Variable*>(_pParentStatement);
+        if (isContainer()) {
+            m_setScoped.insert(_pExpression.get());
+        }
+        else if (pVariable) {
+            m_vecDeclared.push_back({ pVariable->m_strName, _pExpression.get() });
+        }
+    }
+
+    Expression* pParent = _pExpression.get();
+    _pExpression->ForEachChild({
+        [this](const std::shared_ptr<Statement>& _pChild) { VisitStatement(_pChild); },
+        [this, pParent](const std::shared_ptr<Expression>& _pChild) { VisitExpression(_pChild, nullptr, pParent); },
+    });
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <set>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TypeDefine.h"
+#include "Node.h"
+
+// Finds array and map literals that never leave the function that creates them,
+// Generate writes those as PushScopedArray/PushScopedMap so the Machine keeps them out of the GC list
+class EscapeAnalysis
+{
+private:
+	EscapeAnalysis() { }
+	~EscapeAnalysis() { }
+public:
+	static EscapeAnalysis& GetInstance()
+	{
+		static thread_local EscapeAnalysis instance;
+		return instance;
+	}
+#define EscapeMgr		EscapeAnalysis::GetInstance()
+
+public:
+	void Clear();
+	void Analyze(std::shared_ptr<Function> _pFunction);
+	bool IsScoped(const Expression* _pLiteral) const;
+
+private:
+	// Parent is the node holding the expression, only one of the two is set
+	void VisitStatement(const std::shared_ptr<Statement>& _pStatement);
+	void VisitExpression(const std::shared_ptr<Expression>& _pExpression, Statement* _pParentStatement, Expression* _pParentExpression);
+
+public:
+	// Literals allocated in the frame of the function that creates them
+	std::set<const Expression*> m_setScoped;
+
+private:
+	// Per Analyze : variables used other than as the container of an element access,
+	// and the literals each variable is declared with
+	std::set<std::string> m_setEscapedName;
+	std::vector<std::pair<std::string, const Expression*>> m_vecDeclared;
+};
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include "Evaluator.h"
+#include "Optimizer.h"
+#include "CallGraph.h"
+#include "Object.h"
+
+void Evaluator::Clear()
+{
+    m_mapSummary.clear();
+    m_mapEvaluateCount.clear();
+}
+
+void Evaluator::Begin(std::shared_ptr<Function> _pCaller, const std::map<std::string, std::shared_ptr<Function>>& _mapFunction)
+{
+    m_pCaller = _pCaller;
+    m_pFunctionTable = &_mapFunction;
+}
+
+void Evaluator::End()
+{
+    m_pCaller = nullptr;
+    m_pFunctionTable = nullptr;
+}
+
+std::shared_ptr<Expression> Evaluator::Evaluate(const std::string& _strName, const std::vector<std::shared_ptr<Expression>>& _vecArgument)
+{
+    if (m_pCaller == nullptr) {
+        return nullptr;
+    }
+    auto findIt = m_pFunctionTable->find(_strName);
+    // A local of the caller with the same name may hold anything
+    if (findIt == m_pFunctionTable->end() || Summarize(m_pCaller).m_setLocal.count(_strName) ||
+        findIt->second->m_vecParameter.size() != _vecArgument.size() ||
+        std::ranges::all_of(_vecArgument, Optimizer::IsLiteral) == false || IsPure(_strName) == false) {
+        return nullptr;
+    }
+
+    std::vector<std::any> vecValue;
+    for (auto& pArgument : _vecArgument) {
+        vecValue.push_back(pArgument->Interpret());
+    }
+    std::any anyResult;
+    if (InterpreterMgr.Evaluate(findIt->second, vecValue, *m_pFunctionTable, anyResult) == false) {
+        return nullptr;
+    }
+    std::set<const Object*> setSeen;
+    uint64 size = 0;
+    auto pResult = ToLiteral(anyResult, setSeen, size);
+    if (pResult) {
+        m_mapEvaluateCount[m_pCaller->m_strName][_strName] += 1;
+    }
+    return pResult;
+}
+
+bool Evaluator::IsPure(const std::string& _strName)
+{
+    // Pure when nothing reachable through the names it mentions is impure, recursion included
+    std::set<std::string> setVisited = { _strName };
+    std::vector<std::string> vecWork = { _strName };
+    while (vecWork.empty() == false) {
+        auto findIt = m_pFunctionTable->find(vecWork.back());
+        vecWork.pop_back();
+        if (findIt == m_pFunctionTable->end()) {
+            return false;
+        }
+        const Summary& summary = Summarize(findIt->second);
+        if (summary.m_bImpure) {
+            return false;
+        }
+        for (auto& strReference : summary.m_setReference) {
+            if (m_pFunctionTable->count(strReference) == 0) {
+                if (m_setPureBuiltin.count(strReference) == 0 || CallGraphMgr.m_setAssigned.count(strReference)) {
+                    return false;
+                }
+                continue;
+            }
+            if (setVisited.insert(strReference).second) {
+                vecWork.push_back(strReference);
+            }
+        }
+    }
+    return true;
+}
+
+std::string Evaluator::PrintReport()
+{
+    std::string strResult;
+    for (auto& [caller, mapCallee] : m_mapEvaluateCount) {
+        for (auto& [callee, count] : mapCallee) {
+            strResult += caller + " : " + callee + " evaluated " + std::to_string(count) + "\n";
+        }
+    }
+    return strResult;
+}
+
+const Evaluator::Summary& Evaluator::Summarize(const std::shared_ptr<Function>& _pFunction)
+{
+    auto findIt = m_mapSummary.find(_pFunction.get());
+    if (findIt != m_mapSummary.end()) {
+        return findIt->second;
+    }
+    Summary& summary = m_mapSummary[_pFunction.get()];
+    m_pSummary = &summary;
+    m_listScope.clear();
+    m_listScope.emplace_front(_pFunction->m_vecParameter.begin(), _pFunction->m_vecParameter.end());
+    summary.m_setLocal = m_listScope.front();
+    // The body is the parameter scope itself, the interpreter pushes no block for it
+    for (auto& pNode : _pFunction->m_vecBlock) {
+        VisitStatement(pNode);
+    }
+    m_pSummary = nullptr;
+    return summary;
+}
+
+void Evaluator::VisitBlock(const std::vector<std::shared_ptr<Statement>>& _vecBlock)
+{
+    m_listScope.emplace_front();
+    for (auto& pNode : _vecBlock) {
+        VisitStatement(pNode);
+    }
+    m_listScope.pop_front();
+}
+
+void Evaluator::VisitStatement(const std::shared_ptr<Statement>& _pStatement)
+{
+    // Scopes follow the interpreter, a name declared in a branch is not in scope after it
+    if (auto pVariable = std::dynamic_pointer_cast<Variable>(_pStatement)) {
+        if (pVariable->m_pExpression) {
+            VisitExpression(pVariable->m_pExpression);
+        }
+        m_listScope.front().insert(pVariable->m_strName);
+        m_pSummary->m_setLocal.insert(pVariable->m_strName);
+    }
+    else if (auto pFor = std::dynamic_pointer_cast<For>(_pStatement)) {
+        m_listScope.emplace_front();
+        VisitStatement(pFor->m_pVariable);
+        VisitExpression(pFor->m_pCondition);
+        VisitExpression(pFor->m_pExpression);
+        for (auto& pNode : pFor->m_vecBlock) {
+            VisitStatement(pNode);
+        }
+        m_listScope.pop_front();
+    }
+    else if (auto pIf = std::dynamic_pointer_cast<If>(_pStatement)) {
+        for (uint64 i = 0; i < pIf->m_vecCondition.size(); ++i) {
+            VisitExpression(pIf->m_vecCondition[i]);
+            VisitBlock(pIf->m_vecBlocks[i]);
+        }
+        VisitBlock(pIf->m_vecElseBlock);
+    }
+    else if (std::dynamic_pointer_cast<Print>(_pStatement)) {
+        m_pSummary->m_bImpure = true;
+    }
+    else {
+        _pStatement->ForEachChild({
+            [this](const std::shared_ptr<Statement>& _pChild) { VisitStatement(_pChild); },
+            [this](const std::shared_ptr<Expression>& _pChild) { VisitExpression(_pChild); },
+        });
+    }
+}
+
+void Evaluator::VisitExpression(const std::shared_ptr<Expression>& _pExpression)
+{
+    if (auto pGetVariable = std::dynamic_pointer_cast<GetVariable>(_pExpression)) {
+        if (IsDeclared(pGetVariable->m_strName) == false) {
+            m_pSummary->m_setReference.insert(pGetVariable->m_strName);
+        }
+    }
+    else if (auto pSetVariable = std::dynamic_pointer_cast<SetVariable>(_pExpression)) {
+        if (IsDeclared(pSetVariable->m_strName) == false) {
+            m_pSummary->m_bImpure = true;
+        }
+    }
+    else if (std::dynamic_pointer_cast<GetClassAccess>(_pExpression) || std::dynamic_pointer_cast<SetClassAccess>(_pExpression)) {
+        m_pSummary->m_bImpure = true;
+    }
+    else if (auto pCall = std::dynamic_pointer_cast<Call>(_pExpression)) {
+        // Only a callee named in the function table can be followed, a parameter or local may hold anything
+        auto pCallee = std::dynamic_pointer_cast<GetVariable>(pCall->m_pSub);
+        if (pCallee == nullptr || IsDeclared(pCallee->m_strName)) {
+            m_pSummary->m_bImpure = true;
+        }
+    }
+    _pExpression->ForEachChild({
+        [this](const std::shared_ptr<Statement>& _pChild) { VisitStatement(_pChild); },
+        [this](const std::shared_ptr<Expression>& _pChild) { VisitExpression(_pChild); },
+    });
+}
+
+bool Evaluator::IsDeclared(const std::string& _strName) const
+{
+    return std::ranges::any_of(m_listScope, [&](const std::set<std::string>& _scope) { return _scope.count(_strName) != 0; });
+}
+
+std::shared_ptr<Expression> Evaluator::ToLiteral(const std::any& _anyValue, std::set<const Object*>& _setSeen, uint64& _size)
+{
+    if (++_size > m_iLiteralLimit) {
+        return nullptr;
+    }
+    if (Object::IsArray(_anyValue)) {
+        auto pArray = Object::ToArray(_anyValue);
+        // The same object twice would come back as two copies
+        if (_setSeen.insert(pArray.get()).second == false) {
+            return nullptr;
+        }
+        auto pResult = std::make_shared<ArrayLiteral>();
+        for (auto& value : pArray->m_vecValue) {
+            auto pValue = ToLiteral(value, _setSeen, _size);
+            if (pValue == nullptr) {
+                return nullptr;
+            }
+            pResult->m_vecValue.push_back(pValue);
+        }
+        return pResult;
+    }
+    if (Object::IsMap(_anyValue)) {
+        auto pMap = Object::ToMap(_anyValue);
+        if (_setSeen.insert(pMap.get()).second == false) {
+            return nullptr;
+        }
+        auto pResult = std::make_shared<MapLiteral>();
+        for (auto& [key, value] : pMap->m_mapValue) {
+            auto pValue = ToLiteral(value, _setSeen, _size);
+            if (pValue == nullptr) {
+                return nullptr;
+            }
+            pResult->m_mapValue[key] = pValue;
+        }
+        return pResult;
+    }
+    return Optimizer::MakeLiteral(_anyValue);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <any>
+#include <map>
+#include <set>
+#include <list>
+#include <vector>
+#include <memory>
+#include <string>
+#include "TypeDefine.h"
+#include "Node.h"
+#include "Object.h"
+
+// Compile time evaluation : Optimize replaces a call to a pure script function with literal arguments
+// by the literal the Interpreter returns for it. Pure means no globals, no print, no calls through parameters or locals
+// and only the builtins in m_setPureBuiltin
+class Evaluator
+{
+private:
+	Evaluator() { }
+	~Evaluator() { }
+public:
+	static Evaluator& GetInstance()
+	{
+		static thread_local Evaluator instance;
+		return instance;
+	}
+#define EvaluatorMgr		Evaluator::GetInstance()
+
+public:
+	void Clear();
+	// Calls met between Begin and End are evaluated, outside of them Evaluate leaves every call alone
+	void Begin(std::shared_ptr<Function> _pCaller, const std::map<std::string, std::shared_ptr<Function>>& _mapFunction);
+	void End();
+	// Literal replacing the call, nullptr when it has to run at runtime
+	std::shared_ptr<Expression> Evaluate(const std::string& _strName, const std::vector<std::shared_ptr<Expression>>& _vecArgument);
+	bool IsPure(const std::string& _strName);
+	std::string PrintReport();
+
+private:
+	// What a body does on its own, calls are followed by IsPure
+	struct Summary
+	{
+	public:
+		bool m_bImpure = false;
+		std::set<std::string> m_setReference;
+		std::set<std::string> m_setLocal;
+	};
+
+	const Summary& Summarize(const std::shared_ptr<Function>& _pFunction);
+	void VisitBlock(const std::vector<std::shared_ptr<Statement>>& _vecBlock);
+	void VisitStatement(const std::shared_ptr<Statement>& _pStatement);
+	void VisitExpression(const std::shared_ptr<Expression>& _pExpression);
+	bool IsDeclared(const std::string& _strName) const;
+	// Arrays and maps come back as literals of literals, nullptr for values with no literal form
+	std::shared_ptr<Expression> ToLiteral(const std::any& _anyValue, std::set<const Object*>& _setSeen, uint64& _size);
+
+public:
+	std::set<std::string> m_setPureBuiltin = { "length", "push", "pop", "erase", "sqrt" };
+	// Values an evaluated result may hold, elements included, before the call is left alone
+	uint64 m_iLiteralLimit = 256;
+	// Caller -> callee -> calls replaced
+	std::map<std::string, std::map<std::string, uint64>> m_mapEvaluateCount;
+
+private:
+	const std::map<std::string, std::shared_ptr<Function>>* m_pFunctionTable = nullptr;
+	std::shared_ptr<Function> m_pCaller;
+	std::map<const Function*, Summary> m_mapSummary;
+	// Per Summarize : the summary being filled and the variables in scope, innermost first
+	Summary* m_pSummary = nullptr;
+	std::list<std::set<std::string>> m_listScope;
+};
@@ -1,24 +1,105 @@
+#include <cstring>
+#include <cmath>
 #include "Machine.h"
 #include "Object.h"
 #include "Application.h"
+#include "Profile.h"
+#include "TypeInference.h"
 
-void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::size_t>> _objectCode)
+namespace
+{
+    // Type tag followed by the value bytes, false for values a memo table does not hold
+    bool AppendMemoKey(std::string& _strKey, const std::any& _anyValue)
+    {
+        if (Object::IsNull(_anyValue)) {
+            _strKey += 'n';
+            return true;
+        }
+        if (Object::IsBoolean(_anyValue)) {
+            _strKey += Object::ToBoolean(_anyValue) ? 't' : 'f';
+            return true;
+        }
+        if (Object::IsNumber(_anyValue) || Object::IsFloat(_anyValue)) {
+            char buffer[sizeof(uint64)];
+            if (Object::IsNumber(_anyValue)) {
+                uint64 value = Object::ToNumber(_anyValue);
+                memcpy(buffer, &value, sizeof(buffer));
+            }
+            else {
+                float64 value = Object::ToFloat(_anyValue);
+                memcpy(buffer, &value, sizeof(buffer));
+            }
+            _strKey += Object::IsNumber(_anyValue) ? 'u' : 'd';
+            _strKey.append(buffer, sizeof(buffer));
+            return true;
+        }
+        if (Object::IsString(_anyValue)) {
+            std::string strValue = Object::ToString(_anyValue);
+            _strKey += 's' + std::to_string(strValue.size()) + ':' + strValue;
+            return true;
+        }
+        return false;
+    }
+}
+
+void Machine::Execute(std::shared_ptr<const ProgramImage> _pImage)
 {
     m_mapGlobal.clear();
     m_vecObject.clear();
+    m_memoCache.Clear();
+    m_strOutput.clear();
     m_vecCallStack.emplace_back();
-    auto vecCodeList = std::get<0>(_objectCode);
-    auto functionTable = std::get<1>(_objectCode);
+    // The image stays as generated, quickening rewrites only this run's copy of the instructions
+    const std::vector<Code>& vecCodeList = _pImage->m_vecCode;
+    const std::map<std::string, std::size_t>& functionTable = _pImage->m_mapFunctionTable;
+    m_vecInstruction.resize(vecCodeList.size());
+    for (uint64 i = 0; i < vecCodeList.size(); ++i) {
+        m_vecInstruction[i] = vecCodeList[i].m_instruction;
+    }
+    m_vecUnstable.assign(vecCodeList.size(), false);
+    m_iQuickenCount = 0;
+    m_iRevertCount = 0;
+    if (m_bProfile) {
+        ProfileMgr.BeginRun();
+        m_mapEntryName.clear();
+        for (auto& [strName, address] : functionTable) {
+            m_mapEntryName[address] = strName;
+        }
+    }
     while (true) 
     {
-        auto code = vecCodeList[m_vecCallStack.back().m_instructionPointer];
-        switch (code.m_instruction) 
+        const Code& code = vecCodeList[m_vecCallStack.back().m_instructionPointer];
+        Instruction& instruction = m_vecInstruction[m_vecCallStack.back().m_instructionPointer];
+        if (m_bProfile && code.m_iSite) {
+            RecordSite(code);
+        }
+        switch (instruction) 
         {
         case Instruction::Exit: 
             {
                 m_vecCallStack.pop_back();
             }
             return;
+        case Instruction::TailCall: 
+            {
+                // A script function takes over the current frame, anything else runs like Call and the Return after it
+                auto operand = PeekOperand();
+                if (Object::IsSize(operand)) 
+                {
+                    PopOperand();
+                    StackFrame& stackFrame = m_vecCallStack.back();
+                    std::vector<any> vecArgument;
+                    for (size_t i = 0; i < Object::ToSize(code.m_anyOperand); i++) {
+                        vecArgument.push_back(stackFrame.m_vecOperandStack.back());
+                        stackFrame.m_vecOperandStack.pop_back();
+                    }
+                    stackFrame.m_vecVariable = std::move(vecArgument);
+                    stackFrame.m_vecOperandStack.clear();
+                    stackFrame.m_instructionPointer = Object::ToSize(operand);
+                    continue;
+                }
+            }
+            [[fallthrough]];
         case Instruction::Call: 
             {
                 auto operand = PopOperand();
@@ -34,15 +115,18 @@ void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::s
                     continue;
                 }
                 if (Object::IsBuiltinFunction(operand)) {
-                    vector<any> arguments;
-                    for (size_t i = 0; i < Object::ToSize(code.m_anyOperand); i++)
-                        arguments.push_back(PopOperand());
-                    PushOperand(Object::ToBuiltinFunction(operand)(arguments));
+                    CallNative(Object::ToBuiltinFunction(operand), Object::ToSize(code.m_anyOperand));
                     break;
                 }
                 PushOperand(nullptr);
             }
             break;
+        case Instruction::CallNative: 
+            {
+                auto& entry = BuiltinMgr.Get(Object::ToSize(code.m_anyOperand));
+                CallNative(entry.m_function, entry.m_iArity);
+            }
+            break;
         case Instruction::Alloca: 
             {
                 auto extraSize = Object::ToSize(code.m_anyOperand);
@@ -61,6 +145,31 @@ void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::s
                 CollectGarbage();
             }
             break;
+        case Instruction::MemoLoad: 
+            {
+                // Pushes the cached result and true on a hit, false on a miss
+                StackFrame& stackFrame = m_vecCallStack.back();
+                auto slot = Object::ToSize(code.m_anyOperand);
+                any result;
+                if (m_memoCache.Load(stackFrame.m_instructionPointer, stackFrame.m_vecVariable.data(), slot, functionTable, result)) {
+                    PushOperand(result);
+                    PushOperand(true);
+                    break;
+                }
+                stackFrame.m_vecVariable[slot] = std::move(result);
+                PushOperand(false);
+            }
+            break;
+        case Instruction::MemoStore: 
+            {
+                StackFrame& stackFrame = m_vecCallStack.back();
+                any result = nullptr;
+                if (stackFrame.m_vecOperandStack.empty() == false) {
+                    result = stackFrame.m_vecOperandStack.back();
+                }
+                m_memoCache.Store(stackFrame.m_vecVariable[Object::ToSize(code.m_anyOperand)], result);
+            }
+            break;
         case Instruction::Jump: 
             {
                 m_vecCallStack.back().m_instructionPointer = Object::ToSize(code.m_anyOperand);
@@ -75,28 +184,26 @@ void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::s
                 m_vecCallStack.back().m_instructionPointer = Object::ToSize(code.m_anyOperand);
             }
             continue;
-        case Instruction::Print: 
+        case Instruction::LoopJump: 
             {
-#ifdef USE_APPLICATION_IMGUI
-                for (size_t i = 0; i < Object::ToSize(code.m_anyOperand); i++) {
-                    auto value = PopOperand();
-                    ImGui::Text(AnyToString(value).c_str());
+                auto condition = PopOperand();
+                if (Object::IsTrue(condition) == false) {
+                    break;
                 }
-#else                
+                m_vecCallStack.back().m_instructionPointer = Object::ToSize(code.m_anyOperand);
+            }
+            continue;
+        case Instruction::Print: 
+            {
                 for (size_t i = 0; i < Object::ToSize(code.m_anyOperand); i++) {
                     auto value = PopOperand();
-                    std::cout << AnyToString(value).c_str());
+                    m_strOutput += AnyToString(value);
                 }
-#endif
             }
             break;
         case Instruction::PrintLine: 
             {
-#ifdef USE_APPLICATION_IMGUI
-                ImGui::Text("\n");
-#else      
-                std::cout << '\n';
-#endif
+                m_strOutput += '\n';
             }
             break;
         case Instruction::LogicalOr: 
@@ -119,166 +226,154 @@ void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::s
                 }
             }
             break;
+        case Instruction::Add: 
+        case Instruction::Subtract: 
+        case Instruction::Multiply: 
+        case Instruction::Divide: 
+        case Instruction::Modulo: 
         case Instruction::Equal: 
+        case Instruction::NotEqual: 
+        case Instruction::LessThan: 
+        case Instruction::GreaterThan: 
+        case Instruction::LessOrEqual: 
+        case Instruction::GreaterOrEqual: 
             {
                 auto rValue = PopOperand();
                 auto lValue = PopOperand();
-                if (Object::IsNull(lValue) && Object::IsNull(rValue)) {
-                    PushOperand(true);
-                }
-                else if (Object::IsBoolean(lValue) && Object::IsBoolean(rValue)) {
-                    PushOperand(Object::ToBoolean(lValue) == Object::ToBoolean(rValue));
-                }
-                else if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(Object::ToNumber(lValue) == Object::ToNumber(rValue));
-                }
-                else if (Object::IsString(lValue) && Object::IsString(rValue)) {
-                    PushOperand(Object::ToString(lValue) == Object::ToString(rValue));
-                }
-                else {
-                    PushOperand(false);
-                }
+                PushOperand(Operate(ToOperator(instruction), lValue, rValue));
+                Quicken(instruction, lValue, rValue);
             }
             break;
-        case Instruction::NotEqual: 
+        case Instruction::AddU64: 
             {
-                auto rValue = PopOperand();
-                auto lValue = PopOperand();
-                if (Object::IsNull(lValue) && Object::IsNull(rValue)) {
-                    PushOperand(false);
-                }
-                else if (Object::IsNull(lValue) || Object::IsNull(rValue)) {
-                    PushOperand(true);
-                }
-
-                if (Object::IsBoolean(lValue) && Object::IsBoolean(rValue)) {
-                    PushOperand(Object::ToBoolean(lValue) != Object::ToBoolean(rValue));
-                }
-                else if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(Object::ToNumber(lValue) != Object::ToNumber(rValue));
-                }
-                else if (Object::IsString(lValue) && Object::IsString(rValue)) {
-                    PushOperand(Object::ToString(lValue) != Object::ToString(rValue));
-                }
-                else {
-                    PushOperand(false);
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsNumber, Object::IsNumber) == false) {
+                    continue;
                 }
+                auto rValue = Object::ToNumber(PopOperand());
+                auto lValue = Object::ToNumber(PopOperand());
+                PushOperand(lValue + rValue);
             }
             break;
-        case Instruction::LessThan: 
+        case Instruction::SubtractU64: 
             {
-                auto rValue = PopOperand();
-                auto lValue = PopOperand();
-                if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(Object::ToNumber(lValue) < Object::ToNumber(rValue));
-                }
-                else {
-                    PushOperand(false);
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsNumber, Object::IsNumber) == false) {
+                    continue;
                 }
+                auto rValue = Object::ToNumber(PopOperand());
+                auto lValue = Object::ToNumber(PopOperand());
+                PushOperand(lValue - rValue);
             }
             break;
-        case Instruction::GreaterThan: 
+        case Instruction::MultiplyU64: 
             {
-                auto rValue = PopOperand();
-                auto lValue = PopOperand();
-                if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(Object::ToNumber(lValue) > Object::ToNumber(rValue));
-                }
-                else {
-                    PushOperand(false);
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsNumber, Object::IsNumber) == false) {
+                    continue;
                 }
+                auto rValue = Object::ToNumber(PopOperand());
+                auto lValue = Object::ToNumber(PopOperand());
+                PushOperand(lValue * rValue);
             }
             break;
-        case Instruction::LessOrEqual: 
-             {
-                 auto rValue = PopOperand();
-                 auto lValue = PopOperand();
-                 if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                     PushOperand(Object::ToNumber(lValue) <= Object::ToNumber(rValue));
-                 }
-                 else {
-                     PushOperand(false);
-                 }
-             }
-             break;
-        case Instruction::GreaterOrEqual: 
-             {
-                auto rValue = PopOperand();
-                auto lValue = PopOperand();
-                if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(Object::ToNumber(lValue) >= Object::ToNumber(rValue));
-                }
-                else {
-                    PushOperand(false);
+        case Instruction::EqualU64: 
+            {
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsNumber, Object::IsNumber) == false) {
+                    continue;
                 }
+                auto rValue = Object::ToNumber(PopOperand());
+                auto lValue = Object::ToNumber(PopOperand());
+                PushOperand(lValue == rValue);
             }
             break;
-        case Instruction::Add: 
+        case Instruction::NotEqualU64: 
             {
-                auto rValue = PopOperand();
-                auto lValue = PopOperand();
-                if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(Object::ToNumber(lValue) + Object::ToNumber(rValue));
-                }
-                else if (Object::IsString(lValue) && Object::IsString(rValue)) {
-                    PushOperand(Object::ToString(lValue) + Object::ToString(rValue));
-                }
-                else {
-                    PushOperand(0.0);
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsNumber, Object::IsNumber) == false) {
+                    continue;
                 }
+                auto rValue = Object::ToNumber(PopOperand());
+                auto lValue = Object::ToNumber(PopOperand());
+                PushOperand(lValue != rValue);
             }
             break;
-        case Instruction::Subtract: 
+        case Instruction::LessThanU64: 
             {
-                auto rValue = PopOperand();
-                auto lValue = PopOperand();
-                if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(Object::ToNumber(lValue) - Object::ToNumber(rValue));
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsNumber, Object::IsNumber) == false) {
+                    continue;
                 }
-                else {
-                    PushOperand(0.0);
+                auto rValue = Object::ToNumber(PopOperand());
+                auto lValue = Object::ToNumber(PopOperand());
+                PushOperand(lValue < rValue);
+            }
+            break;
+        case Instruction::GreaterThanU64: 
+            {
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsNumber, Object::IsNumber) == false) {
+                    continue;
                 }
+                auto rValue = Object::ToNumber(PopOperand());
+                auto lValue = Object::ToNumber(PopOperand());
+                PushOperand(lValue > rValue);
             }
             break;
-        case Instruction::Multiply: 
+        case Instruction::LessOrEqualU64: 
             {
-                auto rValue = PopOperand();
-                auto lValue = PopOperand();
-                if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(Object::ToNumber(lValue)* Object::ToNumber(rValue));
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsNumber, Object::IsNumber) == false) {
+                    continue;
                 }
-                else {
-                    PushOperand(0.0);
+                auto rValue = Object::ToNumber(PopOperand());
+                auto lValue = Object::ToNumber(PopOperand());
+                PushOperand(lValue <= rValue);
+            }
+            break;
+        case Instruction::GreaterOrEqualU64: 
+            {
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsNumber, Object::IsNumber) == false) {
+                    continue;
                 }
+                auto rValue = Object::ToNumber(PopOperand());
+                auto lValue = Object::ToNumber(PopOperand());
+                PushOperand(lValue >= rValue);
             }
             break;
-        case Instruction::Divide: 
+        case Instruction::ConcatString: 
             {
-                auto rValue = PopOperand();
-                auto lValue = PopOperand();
-                if (Object::IsNumber(lValue) && Object::IsNumber(rValue) && Object::ToNumber(rValue) == 0) {
-                    PushOperand(0.0);
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsString, Object::IsString) == false) {
+                    continue;
                 }
-                else if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(Object::ToNumber(lValue) / Object::ToNumber(rValue));
+                auto rValue = Object::ToString(PopOperand());
+                auto lValue = Object::ToString(PopOperand());
+                PushOperand(lValue + rValue);
+            }
+            break;
+        case Instruction::GetElementArrayU64: 
+            {
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsArray, Object::IsNumber) == false) {
+                    continue;
                 }
-                else {
-                    PushOperand(0.0);
+                auto index = PopOperand();
+                auto sub = PopOperand();
+                PushOperand(Object::GetValueOfArray(sub, index));
+            }
+            break;
+        case Instruction::SetElementArrayU64: 
+            {
+                if (IsGuarded(code, instruction) && GuardOperand(instruction, Object::IsArray, Object::IsNumber) == false) {
+                    continue;
                 }
+                auto index = PopOperand();
+                auto sub = PopOperand();
+                Object::SetValueOfArray(sub, index, PeekOperand());
             }
             break;
-        case Instruction::Modulo: 
+        case Instruction::ShiftLeft: 
             {
                 auto rValue = PopOperand();
                 auto lValue = PopOperand();
-                if (Object::IsNumber(lValue) && Object::IsNumber(rValue) && Object::ToNumber(rValue) == 0) {
-                    PushOperand(0.0);
-                }
-                else if (Object::IsNumber(lValue) && Object::IsNumber(rValue)) {
-                    PushOperand(fmod(Object::ToNumber(lValue), Object::ToNumber(rValue)));
+                if (Object::IsNumber(lValue)) {
+                    PushOperand(Object::ToNumber(lValue) << Object::ToNumber(rValue));
                 }
                 else {
-                    PushOperand(0.0);
+                    // Peephole only emits this for a power of two multiplier, multiply by it for other types
+                    PushOperand(Operate(EOperator::Multiply, lValue, static_cast<uint64>(1) << Object::ToNumber(rValue)));
                 }
             }
             break;
@@ -317,6 +412,7 @@ void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::s
                 else {
                     PushOperand(nullptr);
                 }
+                Quicken(instruction, sub, index);
             }
             break;
         case Instruction::SetElement: 
@@ -329,19 +425,21 @@ void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::s
                 else if (Object::IsMap(sub) && Object::IsString(index)) {
                     Object::SetValueOfMap(sub, index, PeekOperand());
                 }
+                Quicken(instruction, sub, index);
             }
             break;
         case Instruction::GetGlobal: 
             {
+                // Same order as the Interpreter, an assigned global hides a function or builtin of that name
                 auto name = Object::ToString(code.m_anyOperand);
-                if (functionTable.count(name)) {
-                    PushOperand(functionTable[name]);
+                if (m_mapGlobal.count(name)) {
+                    PushOperand(m_mapGlobal[name]);
                 }
-                else if (m_mapBuiltinFunctionTable.count(name)) {
-                    PushOperand(m_mapBuiltinFunctionTable[name]);
+                else if (functionTable.count(name)) {
+                    PushOperand(functionTable.at(name));
                 }
-                else if (m_mapGlobal.count(name)) {
-                    PushOperand(m_mapGlobal[name]);
+                else if (uint64 native = BuiltinMgr.Find(name); native != SIZE_MAX) {
+                    PushOperand(BuiltinMgr.Get(native).m_function);
                 }
                 else {
                     PushOperand(nullptr);
@@ -387,16 +485,23 @@ void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::s
             }
             break;
         case Instruction::PushArray: 
+        case Instruction::PushScopedArray: 
             {
                 auto pResult = std::make_shared<Array>();
                 auto size = Object::ToSize(code.m_anyOperand);
                 for (auto i = size; i > 0; i--)
                     pResult->m_vecValue.push_back(PopOperand());
                 PushOperand(pResult);
-                m_vecObject.push_back(pResult);
+                // Scoped objects live only in the slots and operands of this frame and go away with them.
+                // There is no frame region, they are just never put on the GC list and the shared_ptr
+                // frees them when the last slot holding one is overwritten or its frame is popped
+                if (instruction == Instruction::PushArray) {
+                    m_vecObject.push_back(pResult);
+                }
             }
             break;
         case Instruction::PushMap: 
+        case Instruction::PushScopedMap: 
             {
                 auto pResult = std::make_shared<Map>();
                 for (size_t i = 0; i < Object::ToSize(code.m_anyOperand); i++) {
@@ -405,7 +510,9 @@ void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::s
                     pResult->m_mapValue[key] = value;
                 }
                 PushOperand(pResult);
-                m_vecObject.push_back(pResult);
+                if (instruction == Instruction::PushMap) {
+                    m_vecObject.push_back(pResult);
+                }
             }
             break;
         case Instruction::PopOperand: 
@@ -413,11 +520,246 @@ void Machine::Execute(std::tuple<std::vector<Code>, std::map<std::string, std::s
                 PopOperand();
             }
             break;
+        case Instruction::ArrayLength: 
+            {
+                auto sub = PopOperand();
+                if (Object::IsArray(sub)) {
+                    PushOperand(static_cast<float64>(Object::ToArray(sub)->m_vecValue.size()));
+                }
+                else if (Object::IsMap(sub)) {
+                    PushOperand(static_cast<float64>(Object::ToMap(sub)->m_mapValue.size()));
+                }
+                else {
+                    PushOperand(0.0);
+                }
+            }
+            break;
+        case Instruction::ArrayPush: 
+            {
+                auto sub = PopOperand();
+                auto value = PopOperand();
+                if (Object::IsArray(sub)) {
+                    Object::ToArray(sub)->m_vecValue.push_back(value);
+                    PushOperand(sub);
+                }
+                else {
+                    PushOperand(nullptr);
+                }
+            }
+            break;
+        case Instruction::ArrayPop: 
+            {
+                auto sub = PopOperand();
+                if (Object::IsArray(sub) && Object::ToArray(sub)->m_vecValue.empty() == false) {
+                    PushOperand(Object::ToArray(sub)->m_vecValue.back());
+                    Object::ToArray(sub)->m_vecValue.pop_back();
+                }
+                else {
+                    PushOperand(nullptr);
+                }
+            }
+            break;
+        case Instruction::Sqrt: 
+            {
+                auto value = PopOperand();
+                if (Object::IsNumber(value)) {
+                    PushOperand(std::sqrt(static_cast<float64>(Object::ToNumber(value))));
+                }
+                else if (Object::IsFloat(value)) {
+                    PushOperand(std::sqrt(Object::ToFloat(value)));
+                }
+                else {
+                    PushOperand(0.0);
+                }
+            }
+            break;
         }
         m_vecCallStack.back().m_instructionPointer += 1;
     }
 }
 
+void MemoCache::Clear()
+{
+	m_mapTable.clear();
+	m_iSize = 0;
+}
+
+bool MemoCache::Load(uint64 _iTable, const std::any* _pArgument, uint64 _iCount, 
+	const std::map<std::string, std::size_t>& _functionTable, std::any& _anyResult)
+{
+	MemoKey memoKey = { _iTable };
+	MemoTable& memoTable = m_mapTable[_iTable];
+	if (memoTable.m_strName.empty())
+	{
+		size_t entryAddress = 0;
+		for (auto& [strName, address] : _functionTable)
+		{
+			if (address <= _iTable && address >= entryAddress)
+			{
+				entryAddress = address;
+				memoTable.m_strName = strName;
+			}
+		}
+	}
+	bool bCacheable = true;
+	for (uint64 i = 0; i < _iCount && bCacheable; i++)
+	{
+		bCacheable = AppendMemoKey(memoKey.m_strKey, _pArgument[i]);
+	}
+	auto findIt = bCacheable ? memoTable.m_mapEntry.find(memoKey.m_strKey) : memoTable.m_mapEntry.end();
+	if (findIt != memoTable.m_mapEntry.end())
+	{
+		memoTable.m_listEntry.splice(memoTable.m_listEntry.begin(), memoTable.m_listEntry, findIt->second);
+		memoTable.m_iHit += 1;
+		_anyResult = findIt->second->second;
+		return true;
+	}
+	memoTable.m_iMiss += 1;
+	_anyResult = bCacheable ? std::any(std::move(memoKey)) : std::any(nullptr);
+	return false;
+}
+
+void MemoCache::Store(const std::any& _anyKey, const std::any& _anyValue)
+{
+	std::string strValue;
+	if (_anyKey.type() != typeid(MemoKey) || AppendMemoKey(strValue, _anyValue) == false)
+	{
+		return;
+	}
+	const MemoKey& memoKey = std::any_cast<const MemoKey&>(_anyKey);
+	MemoTable& memoTable = m_mapTable[memoKey.m_iTable];
+	// A recursive call with the same arguments may have stored it already
+	if (memoTable.m_mapEntry.count(memoKey.m_strKey))
+	{
+		return;
+	}
+	memoTable.m_listEntry.emplace_front(memoKey.m_strKey, _anyValue);
+	memoTable.m_mapEntry[memoKey.m_strKey] = memoTable.m_listEntry.begin();
+	m_iSize += 1;
+	if (memoTable.m_listEntry.size() > m_iCapacity)
+	{
+		Evict(memoTable);
+	}
+	if (m_iSize > m_iTotalLimit)
+	{
+		Trim();
+	}
+}
+
+void MemoCache::Trim()
+{
+	for (auto& [table, memoTable] : m_mapTable)
+	{
+		uint64 keepSize = memoTable.m_listEntry.size() / 2;
+		while (memoTable.m_listEntry.size() > keepSize)
+		{
+			Evict(memoTable);
+		}
+	}
+}
+
+std::string MemoCache::PrintReport()
+{
+	std::string strResult;
+	for (auto& [table, memoTable] : m_mapTable)
+	{
+		strResult += memoTable.m_strName + " : " + std::to_string(memoTable.m_iHit) + " hit, " +
+			std::to_string(memoTable.m_iMiss) + " miss, " + std::to_string(memoTable.m_iEvict) + " evicted, " +
+			std::to_string(memoTable.m_listEntry.size()) + " cached\n";
+	}
+	return strResult;
+}
+
+void MemoCache::Evict(MemoTable& _memoTable)
+{
+	_memoTable.m_mapEntry.erase(_memoTable.m_listEntry.back().first);
+	_memoTable.m_listEntry.pop_back();
+	_memoTable.m_iEvict += 1;
+	m_iSize -= 1;
+}
+
+std::string Machine::PrintQuickenReport()
+{
+	return "quickened " + std::to_string(m_iQuickenCount) + ", reverted " + std::to_string(m_iRevertCount) + "\n";
+}
+
+void Machine::Quicken(Instruction& _instruction, const std::any& _lhs, const std::any& _rhs)
+{
+	if (m_bQuicken == false || m_vecUnstable[m_vecCallStack.back().m_instructionPointer])
+	{
+		return;
+	}
+	Instruction instruction = TypeInference::ToTypedInstruction(_instruction, 
+		TypeInference::ToTypeSet(_lhs), TypeInference::ToTypeSet(_rhs));
+	if (instruction != _instruction)
+	{
+		_instruction = instruction;
+		m_iQuickenCount += 1;
+	}
+}
+
+bool Machine::GuardOperand(Instruction& _instruction, bool (*_fnLhs)(std::any), bool (*_fnRhs)(std::any))
+{
+	static const std::map<Instruction, Instruction> mapGenericTable = {
+		{ Instruction::AddU64,				Instruction::Add },
+		{ Instruction::SubtractU64,			Instruction::Subtract },
+		{ Instruction::MultiplyU64,			Instruction::Multiply },
+		{ Instruction::EqualU64,			Instruction::Equal },
+		{ Instruction::NotEqualU64,			Instruction::NotEqual },
+		{ Instruction::LessThanU64,			Instruction::LessThan },
+		{ Instruction::GreaterThanU64,		Instruction::GreaterThan },
+		{ Instruction::LessOrEqualU64,		Instruction::LessOrEqual },
+		{ Instruction::GreaterOrEqualU64,	Instruction::GreaterOrEqual },
+		{ Instruction::ConcatString,		Instruction::Add },
+		{ Instruction::GetElementArrayU64,	Instruction::GetElement },
+		{ Instruction::SetElementArrayU64,	Instruction::SetElement },
+	};
+	auto& vecOperandStack = m_vecCallStack.back().m_vecOperandStack;
+	if (_fnLhs(vecOperandStack[vecOperandStack.size() - 2]) && _fnRhs(vecOperandStack.back()))
+	{
+		return true;
+	}
+	// Back to the generic form for good, the caller runs the instruction again as that
+	_instruction = mapGenericTable.at(_instruction);
+	m_vecUnstable[m_vecCallStack.back().m_instructionPointer] = true;
+	m_iRevertCount += 1;
+	return false;
+}
+
+void Machine::RecordSite(const Code& _code)
+{
+	SiteProfile& site = ProfileMgr.AtCodeSite(_code.m_iSite);
+	site.m_iCount += 1;
+	auto& vecOperandStack = m_vecCallStack.back().m_vecOperandStack;
+	switch (_code.m_instruction)
+	{
+	case Instruction::ConditionJump:
+	case Instruction::LoopJump:
+		site.m_iTrue += Object::IsTrue(vecOperandStack.back()) ? 1 : 0;
+		break;
+	case Instruction::Call:
+	case Instruction::TailCall:
+		{
+			auto& callee = vecOperandStack.back();
+			auto findIt = Object::IsSize(callee) ? m_mapEntryName.find(Object::ToSize(callee)) : m_mapEntryName.end();
+			site.m_mapTarget[findIt != m_mapEntryName.end() ? findIt->second : "builtin"] += 1;
+		}
+		break;
+	case Instruction::Alloca:
+	case Instruction::Jump:
+		// Function entry, or a condition the Peephole folded
+		break;
+	default:
+		// Binary operators, both operands on top of the stack
+		if (vecOperandStack.size() >= 2)
+		{
+			site.m_lhs |= TypeInference::ToTypeSet(vecOperandStack[vecOperandStack.size() - 2]);
+			site.m_rhs |= TypeInference::ToTypeSet(vecOperandStack.back());
+		}
+		break;
+	}
+}
+
 void Machine::PushOperand(std::any _value)
 {
 	m_vecCallStack.back().m_vecOperandStack.push_back(_value);
@@ -435,8 +777,19 @@ std::any Machine::PopOperand()
 	return value;
 }
 
+void Machine::CallNative(NativeFunction _function, uint64 _count)
+{
+	auto& vecOperandStack = m_vecCallStack.back().m_vecOperandStack;
+	// The first argument is on top, the view walks down from it
+	std::any result;
+	_function(NativeArgument(vecOperandStack.data() + vecOperandStack.size() - 1, _count, -1), result);
+	vecOperandStack.resize(vecOperandStack.size() - _count);
+	vecOperandStack.push_back(std::move(result));
+}
+
 void Machine::CollectGarbage()
 {
+	m_iMarkEpoch += 1;
 	for (StackFrame& stackFrame : m_vecCallStack) 
 	{
 		for (auto& value : stackFrame.m_vecOperandStack)
@@ -459,11 +812,11 @@ void Machine::MarkObject(std::any _object)
 {
 	if (Object::IsArray(_object)) 
 	{
-		if (Object::ToArray(_object)->m_bMarked)
+		if (Object::ToArray(_object)->m_iMark == m_iMarkEpoch)
 		{
 			return;
 		}
-		Object::ToArray(_object)->m_bMarked = true;
+		Object::ToArray(_object)->m_iMark = m_iMarkEpoch;
 		for (auto& value : Object::ToArray(_object)->m_vecValue)
 		{
 			MarkObject(value);
@@ -471,11 +824,11 @@ void Machine::MarkObject(std::any _object)
 	}
 	else if (Object::IsMap(_object)) 
 	{
-		if (Object::ToMap(_object)->m_bMarked)
+		if (Object::ToMap(_object)->m_iMark == m_iMarkEpoch)
 		{
 			return;
 		}
-		Object::ToMap(_object)->m_bMarked = true;
+		Object::ToMap(_object)->m_iMark = m_iMarkEpoch;
 		for (auto& [key, value] : Object::ToMap(_object)->m_mapValue)
 		{
 			MarkObject(value);
@@ -485,13 +838,8 @@ void Machine::MarkObject(std::any _object)
 
 void Machine::SweepObject()
 {
-	m_vecObject.remove_if([](std::shared_ptr<Object> _pObject) 
+	m_vecObject.remove_if([this](const std::shared_ptr<Object>& _pObject)
 	{
-		if (_pObject->m_bMarked)
-		{
-			_pObject->m_bMarked = false;
-			return false;
-		}
-		return true;
+		return _pObject->m_iMark != m_iMarkEpoch;
 	});
 }
@@ -6,9 +6,12 @@
 #include <any>
 #include <tuple>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include "Token.h"
 #include "Node.h"
+#include "Builtin.h"
+#include "ProgramImage.h"
 
 class Object;
 class Code;
@@ -21,19 +24,86 @@ public:
 	std::size_t m_instructionPointer = 0;
 };
 
-class Machine
+// Results of one memo function, bounded and dropped least recently used first
+struct MemoTable
+{
+public:
+	using EntryList = std::list<std::pair<std::string, std::any>>;
+
+	std::string m_strName;
+	// Most recently used first
+	EntryList m_listEntry;
+	std::unordered_map<std::string, EntryList::iterator> m_mapEntry;
+	uint64 m_iHit = 0;
+	uint64 m_iMiss = 0;
+	uint64 m_iEvict = 0;
+};
+
+// Left by MemoLoad in the hidden local of a memo function for the MemoStore of the same call
+struct MemoKey
+{
+public:
+	uint64 m_iTable = 0;
+	std::string m_strKey;
+};
+
+// Memo tables of one run, shared by the stack and the register machine
+class MemoCache
 {
+public:
+	void Clear();
+	// Hit : true with the cached result, miss : false with the key for Store, null when an argument can not be a key
+	bool Load(uint64 _iTable, const std::any* _pArgument, uint64 _iCount, 
+		const std::map<std::string, std::size_t>& _functionTable, std::any& _anyResult);
+	// Objects are left out, a cached one would be shared by every later caller
+	void Store(const std::any& _anyKey, const std::any& _anyValue);
+	// Every memo table drops its older half, run on its own once m_iTotalLimit is passed
+	void Trim();
+	// Hits, misses and evictions per memo function of the last run
+	std::string PrintReport();
+
+public:
+	// Entries one memo table may hold, and all of them together
+	uint64 m_iCapacity = 1024;
+	uint64 m_iTotalLimit = 1 << 16;
+
 private:
-	Machine() { }
+	void Evict(MemoTable& _memoTable);
+
+private:
+	// Address of the MemoLoad of each memo function -> its table
+	std::map<uint64, MemoTable> m_mapTable;
+	uint64 m_iSize = 0;
+};
+
+// Every Machine is an isolate with its own heap, globals, stacks and memo tables, so one per thread can run
+// scripts side by side on shared ProgramImages. GetInstance is the one of the calling thread, as are the
+// Generater and the other passes, and Builtin is the only table every thread reads
+class Machine
+{
 public:
+	Machine() { }
 	__forceinline static Machine& GetInstance()
 	{
-		static Machine instance;
+		static thread_local Machine instance;
 		return instance;
 	}
 
 public:
-	void Execute(std::tuple<std::vector<Code>, std::map<std::string, std::size_t>> _objectCode);
+	// Runs the image in place, any number of runs may share it
+	void Execute(std::shared_ptr<const ProgramImage> _pImage);
+	// Instructions quickened and reverted by the last Execute
+	std::string PrintQuickenReport();
+
+public:
+	MemoCache m_memoCache;
+	// Text of Print and PrintLine since the last Execute, a worker thread never draws, the UI thread shows it
+	std::string m_strOutput;
+	// Rewrites generic instructions to the typed ones for the operand types they ran with,
+	// a typed instruction meeting other types goes back to the generic one and stays there
+	bool m_bQuicken = true;
+	// Records feedback into ProfileMgr at every tagged code, off outside profiled runs
+	bool m_bProfile = false;
 
 private:
 	void PushOperand(std::any _value);
@@ -42,13 +112,31 @@ private:
 	void CollectGarbage();
 	void MarkObject(std::any _object);
 	void SweepObject();
+	void RecordSite(const Code& _code);
+	void Quicken(Instruction& _instruction, const std::any& _lhs, const std::any& _rhs);
+	// Typed instructions the generator wrote from a proof run unchecked, only the ones quickened at run time
+	// and the profile guesses check their operands
+	__forceinline static bool IsGuarded(const Code& _code, Instruction _instruction)
+	{
+		return _instruction != _code.m_instruction || _code.m_bSpeculative;
+	}
+	// False when the operands on top of the stack fail the checks of the typed instruction
+	bool GuardOperand(Instruction& _instruction, bool (*_fnLhs)(std::any), bool (*_fnRhs)(std::any));
+	// Runs the builtin on the top _count operands and leaves its result in their place
+	void CallNative(NativeFunction _function, uint64 _count);
 
 private:
-	using GenerateFunction = std::function<std::any(std::vector<std::any>)>;
-
 	std::list<std::shared_ptr<Object>> m_vecObject;
+	// Bumped by each CollectGarbage, an object is reachable when its m_iMark caught up with it
+	uint64 m_iMarkEpoch = 0;
 	std::map<std::string, std::any> m_mapGlobal;
 	std::vector<StackFrame> m_vecCallStack;
-	std::map<std::string, GenerateFunction> m_mapBuiltinFunctionTable;
+	// Entry address -> function name, for the call targets of the profile
+	std::map<uint64, std::string> m_mapEntryName;
+	// Per instruction of the running image : what it runs as after quickening, and reverted once so never quickened again
+	std::vector<Instruction> m_vecInstruction;
+	std::vector<bool> m_vecUnstable;
+	uint64 m_iQuickenCount = 0;
+	uint64 m_iRevertCount = 0;
 };
 
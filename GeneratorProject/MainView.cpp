@@ -16,6 +16,14 @@ namespace fs = std::filesystem;
 #include "Parser.h"
 #include "Object.h"
 #include "Machine.h"
+#include "Profile.h"
+#include "RegisterGenerator.h"
+#include "RegisterMachine.h"
+#include "Pipeline.h"
+#include "Peephole.h"
+#include "CallGraph.h"
+#include "Evaluator.h"
+#include "SlotAllocator.h"
 
 namespace
 {
@@ -73,11 +81,11 @@ namespace
         return strResult;
     }
 
-    std::string PrintObjectCode(std::tuple<CodeList, FunctionMap>& _tupleCodeTable)
+    std::string PrintObjectCode(const ProgramImage& _image)
     {
         string strResult = "FUNCTION\t\tADDESS\n";
-        CodeList& vecCode = std::get<0>(_tupleCodeTable);
-        FunctionMap& mapFunction = std::get<1>(_tupleCodeTable);
+        const CodeList& vecCode = _image.m_vecCode;
+        auto& mapFunction = _image.m_mapFunctionTable;
 
         strResult += string(18, '-') + '\n';
         for (auto& [strFuncName, funcAddress] : mapFunction) {
@@ -215,8 +223,13 @@ void MainView::Update()
 
                 m_pProgram = Parser::GetInstance().Parse(tokenList);
                 m_strParserText = PrintSyntaxTree(m_pProgram);
-                m_codeTable = Generater::GetInstance().Generate(m_pProgram);
-                m_strGenerateText = PrintObjectCode(m_codeTable);
+                // Runs so far of this script, left empty so nothing is guessed when PGO is off
+                ProfileMgr.Clear();
+                if (Machine::GetInstance().m_bProfile) {
+                    ProfileMgr.Load(g_directory + "\\" + "profile.pgo");
+                }
+                m_pImage = ProgramImage::Create(Generater::GetInstance().Generate(m_pProgram));
+                m_strGenerateText = ProfileMgr.PrintReport() + CallGraphMgr.PrintReport() + PeepholeMgr.PrintReport() + SlotAllocatorMgr.PrintReport() + GeneraterMgr.PrintInlineReport() + EvaluatorMgr.PrintReport() + PrintObjectCode(*m_pImage);
             }
             catch (std::out_of_range& e)
             {
@@ -227,6 +240,48 @@ void MainView::Update()
         }
     }
     ImGui::SameLine();
+    if (ImGui::Button("Pipeline")) {
+        auto findIt = g_mapPMFilePath.find(m_strInputFileBuffer.data());
+        if (findIt == g_mapPMFilePath.end()) {
+            return;
+        }
+
+        std::ifstream file;
+        file.open(g_directory + "\\" + findIt->first);
+        if (file.is_open()) {
+            std::stringstream stringBuffer;
+            stringBuffer << file.rdbuf();
+
+            m_strFileContext = stringBuffer.str();
+            try
+            {
+                // Token list is never materialized in this mode
+                m_strPrintTokenKindText.clear();
+                m_strPrintTokenStringText.clear();
+
+                m_pImage = ProgramImage::Create(PipelineMgr.Compile(m_strFileContext));
+                m_pProgram = PipelineMgr.m_pProgram;
+                m_strParserText = PrintSyntaxTree(m_pProgram);
+                m_strGenerateText = PeepholeMgr.PrintReport() + SlotAllocatorMgr.PrintReport() + GeneraterMgr.PrintInlineReport() + EvaluatorMgr.PrintReport() + PrintObjectCode(*m_pImage);
+            }
+            catch (std::out_of_range& e)
+            {
+                file.close();
+            }
+
+            file.close();
+        }
+    }
+    ImGui::SameLine();
+    bool bSSA = GeneraterMgr.m_eMode == EGenerateMode::SSA;
+    if (ImGui::Checkbox("SSA", &bSSA)) {
+        GeneraterMgr.m_eMode = bSSA ? EGenerateMode::SSA : EGenerateMode::Tree;
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("PGO", &Machine::GetInstance().m_bProfile);
+    ImGui::SameLine();
+    ImGui::Checkbox("Register", &m_bRegister);
+    ImGui::SameLine();
     ImGui::InputText("File Name", m_strInputFileBuffer.data(), Input_file_buffer_size);
 
     if (ImGui::BeginListBox("File List", ImVec2{ 400, 200 })) {
@@ -308,11 +363,23 @@ void MainView::End()
 {
 }
 
-void MainView::Interpret()
+std::string MainView::Interpret()
 {
-    if (m_pProgram)
+    if (m_pProgram && m_pImage)
     {
         //Interpreter::GetInstance().Interpret(m_pProgram);
-        Machine::GetInstance().Execute(m_codeTable);
+        //return Interpreter::GetInstance().m_strOutput;
+        if (m_bRegister) {
+            RegisterMachine::GetInstance().Execute(RegisterGeneratorMgr.Generate(*m_pImage));
+            std::cout << RegisterGeneratorMgr.PrintReport() << RegisterMachine::GetInstance().m_memoCache.PrintReport();
+            return RegisterMachine::GetInstance().m_strOutput;
+        }
+        Machine::GetInstance().Execute(m_pImage);
+        std::cout << Machine::GetInstance().m_memoCache.PrintReport() << Machine::GetInstance().PrintQuickenReport();
+        if (Machine::GetInstance().m_bProfile) {
+            ProfileMgr.Save(g_directory + "\\" + "profile.pgo");
+        }
+        return Machine::GetInstance().m_strOutput;
     }
+    return "";
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "IWindowView.h"
 #include "Application.h"
+#include "ProgramImage.h"
 
 using CodeList = vector<Code>;
 using FunctionMap = std::map<std::string, uint64>;
@@ -19,7 +20,8 @@ public:
 	void End() override;
 
 public:
-	void Interpret();
+	// Runs the script on this thread's machine and returns what it printed, drawing it is left to the UI thread
+	std::string Interpret();
 
 private:
 	const int64 Input_file_buffer_size = 1024;
@@ -34,6 +36,8 @@ private:
 	std::string m_strBackUp;
 
 	std::shared_ptr<Program> m_pProgram = nullptr;
-	std::tuple<CodeList, FunctionMap> m_codeTable;
+	std::shared_ptr<const ProgramImage> m_pImage = nullptr;
+	// Interpret lowers m_pImage for the RegisterMachine instead of running it on the Machine
+	bool m_bRegister = false;
 };
 
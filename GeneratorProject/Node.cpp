@@ -1,9 +1,19 @@
 #include <iostream>
 #include <list>
 #include <functional>
-#include <regex>
+#include <utility>
 #include "Node.h"
 #include "Object.h"
+#include "Closure.h"
+#include "Optimizer.h"
+#include "Peephole.h"
+#include "SSA.h"
+#include "Escape.h"
+#include "TypeInference.h"
+#include "CallGraph.h"
+#include "Evaluator.h"
+#include "SlotAllocator.h"
+#include "Profile.h"
 
 #include "Application.h"
 
@@ -15,6 +25,29 @@ struct ReturnException
 };
 struct BreakException {};
 struct ContinueException {};
+struct StepLimitException {};
+
+// Operand type for picking the opcode, narrowed to a number when the profile saw nothing else at the site
+static TypeSet ProfiledType(const Expression* _pSite, const Expression* _pOperand, bool _bLhs)
+{
+    TypeSet type = TypeInferenceMgr.TypeOf(_pOperand);
+    const SiteProfile* pProfile = ProfileMgr.Find(_pSite);
+    if (pProfile && pProfile->m_iCount != 0 && (type & TypeNumber) && (_bLhs ? pProfile->m_lhs : pProfile->m_rhs) == TypeNumber) {
+        return TypeNumber;
+    }
+    return type;
+}
+
+// Writes the typed form of the binary instruction for the operand types of the site, a form only the profile
+// picked is marked speculative so the Machine checks it and a wrong guess only costs the generic path
+static uint64 WriteTypedCode(Instruction _instruction, const Expression* _pSite, const Expression* _pLhs, const Expression* _pRhs)
+{
+    Instruction proven = TypeInference::ToTypedInstruction(_instruction, TypeInferenceMgr.TypeOf(_pLhs), TypeInferenceMgr.TypeOf(_pRhs));
+    Instruction guessed = TypeInference::ToTypedInstruction(_instruction, ProfiledType(_pSite, _pLhs, true), ProfiledType(_pSite, _pRhs, false));
+    uint64 code = GeneraterMgr.WriteCode(guessed);
+    GeneraterMgr.m_vecCodeList[code].m_bSpeculative = guessed != proven;
+    return code;
+}
 
 static std::string Indent(int32 _depth)
 {
@@ -30,10 +63,13 @@ void PrintSyntaxTree(Program* program)
 
 void Interpreter::Interpret(std::shared_ptr<Program> _pProgram)
 {
+    OptimizerMgr.Optimize(_pProgram);
+
     // Clear
     InterpreterMgr.m_mapFunctionTable.clear();
     InterpreterMgr.m_mapGlobal.clear();
     InterpreterMgr.m_listLocalFrame.clear();
+    InterpreterMgr.m_strOutput.clear();
     for (auto& node : _pProgram->m_vecFunction) {
         InterpreterMgr.m_mapFunctionTable[node->m_strName] = node;
     }
@@ -41,6 +77,11 @@ void Interpreter::Interpret(std::shared_ptr<Program> _pProgram)
         std::cout << "Cannot find main function\n";
         return;
     }
+    if (InterpreterMgr.m_eMode == EInterpretMode::Closure) {
+        ClosureCompilerMgr.Compile(_pProgram);
+        ClosureCompilerMgr.Run("main");
+        return;
+    }
     InterpreterMgr.m_listLocalFrame.emplace_back().emplace_front();
     try {
         InterpreterMgr.m_mapFunctionTable["main"]->Interpret();
@@ -51,62 +92,131 @@ void Interpreter::Interpret(std::shared_ptr<Program> _pProgram)
     InterpreterMgr.m_listLocalFrame.pop_back();
 }
 
-Interpreter::Interpreter()
-{
-    m_mapBuiltinFunctionTable = {
-        {"length", [](vector<any> values)->any {
-          if (values.size() == 1 && Object::IsArray(values[0])) {
-              return static_cast<float64>(Object::ToArray(values[0])->m_vecValue.size());
-          }
-          if (values.size() == 1 && Object::IsMap(values[0])) {
-              return static_cast<float64>(Object::ToMap(values[0])->m_mapValue.size());
-          }
-          return 0.0;
-        }},
-        {"push", [](vector<any> values)->any {
-          if (values.size() == 2 && Object::IsArray(values[0])) {
-            Object::ToArray(values[0])->m_vecValue.push_back(values[1]);
-            return values[0];
-          }
-          return nullptr;
-        }},
-        {"pop", [](vector<any> values)->any {
-          if (values.size() == 1 && Object::IsArray(values[0]) && Object::ToArray(values[0])->m_vecValue.size() != 0) {
-            auto result = Object::ToArray(values[0])->m_vecValue.back();
-            Object::ToArray(values[0])->m_vecValue.pop_back();
-            return result;
-          }
-          return nullptr;
-        }},
-        {"erase", [](vector<any> values)->any {
-          if (values.size() == 2 && Object::IsMap(values[0]) && Object::IsString(values[1]) &&
-              Object::ToMap(values[0])->m_mapValue.count(Object::ToString(values[1]))) {
-            auto result = Object::ToMap(values[0])->m_mapValue.at(Object::ToString(values[1]));
-            Object::ToMap(values[0])->m_mapValue.erase(Object::ToString(values[1]));
-            return result;
-          }
-          return nullptr;
-        }},
-        {"clock", [](vector<any> values)->any {
-          return static_cast<float64>(clock());
-        }},
-        {"sqrt", [](vector<any> values)->any {
-          return sqrt(Object::ToNumber(values[0]));
-        }},
-    };
+bool Interpreter::Evaluate(std::shared_ptr<Function> _pFunction, const std::vector<std::any>& _vecArgument,
+        const std::map<std::string, std::shared_ptr<Function>>& _mapFunction, std::any& _anyResult)
+{
+    // Whatever the interpreter was running is put back afterwards
+    auto mapGlobal = std::exchange(m_mapGlobal, {});
+    auto listLocalFrame = std::exchange(m_listLocalFrame, {});
+    auto mapFunctionTable = std::exchange(m_mapFunctionTable, _mapFunction);
+    m_iStepBudget = m_iStepLimit;
+
+    std::map<std::string, std::any> mapParameter;
+    for (uint64 i = 0; i < _vecArgument.size(); ++i) {
+        mapParameter[_pFunction->m_vecParameter[i]] = _vecArgument[i];
+    }
+    m_listLocalFrame.emplace_back().push_front(mapParameter);
+    bool bResult = true;
+    _anyResult = nullptr;
+    try {
+        _pFunction->Interpret();
+    }
+    catch (ReturnException exception) {
+        _anyResult = exception.result;
+    }
+    catch (StepLimitException) {
+        bResult = false;
+    }
+    catch (BreakException) {}
+    catch (ContinueException) {}
+
+    m_iStepBudget = 0;
+    m_mapGlobal = std::move(mapGlobal);
+    m_listLocalFrame = std::move(listLocalFrame);
+    m_mapFunctionTable = std::move(mapFunctionTable);
+    return bResult;
+}
+
+void Interpreter::Step()
+{
+    if (m_iStepBudget == 0) {
+        return;
+    }
+    if (--m_iStepBudget == 0 || m_listLocalFrame.size() > m_iDepthLimit) {
+        throw StepLimitException();
+    }
 }
 
 std::tuple<std::vector<Code>, std::map<std::string, std::size_t>>
         Generater::Generate(std::shared_ptr<Program> _pProgram)
+{
+    BeginGenerate();
+    CallGraphMgr.Prune(_pProgram);
+    for (auto& pNode : _pProgram->m_vecFunction) {
+        m_setFunctionName.insert(pNode->m_strName);
+        // A name assigned to anywhere may hold another function by the time it is called
+        if (CallGraphMgr.m_setAssigned.count(pNode->m_strName) == 0) {
+            m_mapInlineCandidate[pNode->m_strName] = pNode;
+        }
+    }
+    m_bWholeProgram = true;
+    for (auto& pNode : _pProgram->m_vecFunction) {
+        OptimizeFunction(pNode);
+    }
+    for (auto& pNode : _pProgram->m_vecFunction) {
+        EmitFunction(pNode);
+    }
+    return EndGenerate();
+}
+
+void Generater::BeginGenerate()
 {
     m_vecCodeList.clear();
     m_mapFunctionTable.clear();
+    m_setFunctionName.clear();
+    m_bWholeProgram = false;
+    m_bMemo = false;
+    m_mapInlineCandidate.clear();
+    m_mapInlineCount.clear();
+    CallGraphMgr.m_setAssigned.clear();
+    EscapeMgr.Clear();
+    TypeInferenceMgr.Clear();
+    EvaluatorMgr.Clear();
+    ProfileMgr.BeginCompile();
     WriteCode(Instruction::GetGlobal, string("main"));
     WriteCode(Instruction::Call, static_cast<size_t>(0));
     WriteCode(Instruction::Exit);
-    for (auto& pNode : _pProgram->m_vecFunction) {
-        pNode->Generate();
+}
+
+void Generater::GenerateFunction(std::shared_ptr<Function> _pFunction)
+{
+    OptimizeFunction(_pFunction);
+    EmitFunction(_pFunction);
+}
+
+void Generater::OptimizeFunction(std::shared_ptr<Function> _pFunction)
+{
+    EvaluatorMgr.Begin(_pFunction, m_mapInlineCandidate);
+    _pFunction->Optimize();
+    // Fed one by one only the functions before this one are known, Generate has put in all it may take
+    if (m_bWholeProgram == false) {
+        m_mapInlineCandidate[_pFunction->m_strName] = _pFunction;
+    }
+    // Replaying a cached result is only right when the call has no other effect
+    if (_pFunction->m_bMemo && EvaluatorMgr.IsPure(_pFunction->m_strName) == false) {
+        std::cout << _pFunction->m_strName << " is not pure, memo ignored\n";
+        _pFunction->m_bMemo = false;
     }
+    EvaluatorMgr.End();
+    // Numbered once optimized, the same script numbers the same way on every compile
+    ProfileMgr.NumberSites(_pFunction);
+}
+
+void Generater::EmitFunction(std::shared_ptr<Function> _pFunction)
+{
+    m_bMemo = _pFunction->m_bMemo;
+    EscapeMgr.Analyze(_pFunction);
+    TypeInferenceMgr.Analyze(_pFunction);
+    if (m_eMode != EGenerateMode::SSA || m_bMemo || SSAMgr.Generate(_pFunction) == false) {
+        _pFunction->Generate();
+    }
+    TagSite(m_mapFunctionTable[_pFunction->m_strName], _pFunction.get());
+}
+
+std::tuple<std::vector<Code>, std::map<std::string, std::size_t>> Generater::EndGenerate()
+{
+    PeepholeMgr.Optimize(m_vecCodeList, m_mapFunctionTable);
+    SlotAllocatorMgr.Allocate(m_vecCodeList, m_mapFunctionTable);
     return { m_vecCodeList, m_mapFunctionTable };
 }
 
@@ -163,17 +273,143 @@ void Generater::PatchAddress(uint64 _codeIndex)
     m_vecCodeList[_codeIndex].m_anyOperand = m_vecCodeList.size();
 }
 
+void Generater::TagSite(uint64 _codeIndex, const void* _pNode, uint64 _offset)
+{
+    m_vecCodeList[_codeIndex].m_iSite = ProfileMgr.ToCodeSite(_pNode, _offset);
+}
+
 void Generater::PatchOperand(uint64 _codeIndex, uint64 _operand)
 {
     m_vecCodeList[_codeIndex].m_anyOperand = _operand;
 }
 
+bool Generater::FindIntrinsic(const std::string& _strName, uint64 _argumentCount, Instruction& _instruction) const
+{
+    static const std::map<std::string, std::pair<Instruction, uint64>> mapIntrinsicTable = {
+        { "length", { Instruction::ArrayLength, 1 } },
+        { "push",   { Instruction::ArrayPush,   2 } },
+        { "pop",    { Instruction::ArrayPop,    1 } },
+        { "sqrt",   { Instruction::Sqrt,        1 } },
+    };
+    auto iter = mapIntrinsicTable.find(_strName);
+    if (m_bWholeProgram == false || iter == mapIntrinsicTable.end() || iter->second.second != _argumentCount ||
+        m_setFunctionName.count(_strName) || CallGraphMgr.m_setAssigned.count(_strName)) {
+        return false;
+    }
+    _instruction = iter->second.first;
+    return true;
+}
+
+bool Generater::FindNative(const std::string& _strName, uint64 _argumentCount, uint64& _index) const
+{
+    uint64 index = BuiltinMgr.Find(_strName);
+    if (m_bWholeProgram == false || index == SIZE_MAX || BuiltinMgr.Get(index).m_iArity != _argumentCount ||
+        m_setFunctionName.count(_strName) || CallGraphMgr.m_setAssigned.count(_strName)) {
+        return false;
+    }
+    _index = index;
+    return true;
+}
+
+bool Generater::GenerateInline(const std::string& _strName, std::vector<std::shared_ptr<Expression>>& _vecArgument, bool _bTailCall,
+        const Expression* _pCallSite)
+{
+    auto findIt = m_mapInlineCandidate.find(_strName);
+    if (findIt == m_mapInlineCandidate.end() || m_vecInlineStack.empty()) {
+        return false;
+    }
+    auto pCallee = findIt->second;
+    // The profile moves the budget : a site that never ran is left a Call, a hot one may take a bigger body
+    const SiteProfile* pProfile = ProfileMgr.Find(_pCallSite);
+    uint64 budget = m_iInlineBudget;
+    if (pProfile && pProfile->m_iCount == 0 && pCallee->m_eInline != EInlineHint::Always) {
+        return false;
+    }
+    if (pProfile && pProfile->m_iCount >= ProfileMgr.m_iHotCallCount) {
+        budget *= ProfileMgr.m_iHotInlineScale;
+    }
+    if (pCallee->m_eInline == EInlineHint::Never || pCallee->m_bMemo || pCallee->m_vecParameter.size() != _vecArgument.size() ||
+        m_vecInlineStack.size() > m_iInlineDepth ||
+        std::find(m_vecInlineStack.begin(), m_vecInlineStack.end(), _strName) != m_vecInlineStack.end()) {
+        return false;
+    }
+
+    // Written speculatively, everything is rolled back when the body goes over the budget
+    uint64 codeSize = m_vecCodeList.size();
+    uint64 localSize = m_iLocalSize;
+    auto mapInlineCount = m_mapInlineCount;
+
+    // Arguments are evaluated in the same order as Call, the first one ends up on top
+    for (uint64 i = _vecArgument.size(); i > 0; --i) {
+        _vecArgument[i - 1]->Generate();
+    }
+
+    // The callee sees its own symbols only, its locals go after the caller's live ones
+    auto listSymbolStackTable = std::move(m_listSymbolStackTable);
+    m_listSymbolStackTable.clear();
+    PushBlock();
+    for (auto& strParameter : pCallee->m_vecParameter) {
+        SetLocal(strParameter);
+        WriteCode(Instruction::SetLocal, GetLocal(strParameter));
+        WriteCode(Instruction::PopOperand);
+    }
+    uint64 bodyAddress = m_vecCodeList.size();
+    m_vecInlineStack.push_back(_strName);
+    if (_bTailCall == false) {
+        m_vecInlineReturnStack.emplace_back();
+    }
+    for (auto& pNode : pCallee->m_vecBlock) {
+        pNode->Generate();
+    }
+    // Falling off the end returns null
+    WriteCode(Instruction::PushNull);
+    if (_bTailCall == false) {
+        for (uint64 jump : m_vecInlineReturnStack.back()) {
+            PatchAddress(jump);
+        }
+        m_vecInlineReturnStack.pop_back();
+    }
+    m_vecInlineStack.pop_back();
+    PopBlock();
+    m_listSymbolStackTable = std::move(listSymbolStackTable);
+
+    // A body still calling itself is recursive and stays a Call
+    bool bRecursive = std::any_of(m_vecCodeList.begin() + bodyAddress, m_vecCodeList.end(), [&](Code& _code) {
+        return _code.m_instruction == Instruction::GetGlobal && std::any_cast<std::string>(_code.m_anyOperand) == _strName;
+    });
+    if (bRecursive || (pCallee->m_eInline != EInlineHint::Always && m_vecCodeList.size() - bodyAddress > budget)) {
+        m_vecCodeList.resize(codeSize);
+        m_iLocalSize = localSize;
+        m_mapInlineCount = std::move(mapInlineCount);
+        return false;
+    }
+    m_mapInlineCount[m_vecInlineStack.front()][_strName] += 1;
+    return true;
+}
+
+std::string Generater::PrintInlineReport()
+{
+    std::string strResult;
+    for (auto& [caller, mapCallee] : m_mapInlineCount) {
+        for (auto& [callee, count] : mapCallee) {
+            strResult += caller + " : " + callee + " inlined " + std::to_string(count) + "\n";
+        }
+    }
+    return strResult;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // - Function
 std::string Function::PrintInfo(int32 _depth)
 {
     std::string strResult 
         = Indent(_depth) + "FUNCTION " + m_strName + " : \n";
+    if (m_eInline != EInlineHint::Default) {
+        strResult += Indent(_depth + 1) + (m_eInline == EInlineHint::Always ? "INLINE\n" : "NOINLINE\n");
+    }
+    if (m_bMemo) {
+        strResult += Indent(_depth + 1) + "MEMO\n";
+    }
     if (m_vecParameter.size()) {
         strResult += Indent(_depth + 1); 
         strResult += "PARAMETERS:";
@@ -189,6 +425,13 @@ std::string Function::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void Function::ForEachChild(const ChildVisitor& _visitor)
+{
+    for (auto& pNode : m_vecBlock) {
+        _visitor.m_fnStatement(pNode);
+    }
+}
+
 void Function::Interpret()
 {
     for (auto& pNode : m_vecBlock) {
@@ -198,18 +441,32 @@ void Function::Interpret()
 
 void Function::Generate()
 {
+    GeneraterMgr.m_vecInlineStack.push_back(m_strName);
     GeneraterMgr.m_mapFunctionTable[m_strName] = GeneraterMgr.m_vecCodeList.size();
     auto temp = GeneraterMgr.WriteCode(Instruction::Alloca);
     GeneraterMgr.InitBlock();
     for (std::string& paramName : m_vecParameter) {
         GeneraterMgr.SetLocal(paramName);
     }
+    if (GeneraterMgr.m_bMemo) {
+        // Hit returns the cached result before the body runs, miss goes on with the key in the hidden local
+        GeneraterMgr.m_iMemoSlot = m_vecParameter.size();
+        GeneraterMgr.SetLocal("#memo");
+        GeneraterMgr.WriteCode(Instruction::MemoLoad, GeneraterMgr.m_iMemoSlot);
+        uint64 missJump = GeneraterMgr.WriteCode(Instruction::ConditionJump);
+        GeneraterMgr.WriteCode(Instruction::Return);
+        GeneraterMgr.PatchAddress(missJump);
+    }
     for (auto& pScope : m_vecBlock) {
         pScope->Generate();
     }
     GeneraterMgr.PopBlock();
     GeneraterMgr.PatchOperand(temp, GeneraterMgr.m_iLocalSize);
+    if (GeneraterMgr.m_bMemo) {
+        GeneraterMgr.WriteCode(Instruction::MemoStore, GeneraterMgr.m_iMemoSlot);
+    }
     GeneraterMgr.WriteCode(Instruction::Return);
+    GeneraterMgr.m_vecInlineStack.pop_back();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -235,11 +492,22 @@ std::string For::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void For::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnStatement(m_pVariable);
+    _visitor.m_fnExpression(m_pCondition);
+    _visitor.m_fnExpression(m_pExpression);
+    for (auto& pNode : m_vecBlock) {
+        _visitor.m_fnStatement(pNode);
+    }
+}
+
 void For::Interpret()
 {
     InterpreterMgr.m_listLocalFrame.back().emplace_front();
     m_pVariable->Interpret();
     while (true) {
+        InterpreterMgr.Step();
         auto result = m_pCondition->Interpret();
         if (Object::IsTrue(result) == false) {
             break;
@@ -267,10 +535,12 @@ void For::Generate()
 
     GeneraterMgr.PushBlock();
     m_pVariable->Generate();
-    uint64 jumpAddress = GeneraterMgr.m_vecCodeList.size();
+    // Inverted : tested once on entry, then at the bottom where LoopJump goes back while it holds
     m_pCondition->Generate();
     uint64 conditionJump = GeneraterMgr.WriteCode(Instruction::ConditionJump);
+    auto symbolTable = GeneraterMgr.m_listSymbolStackTable.front();
 
+    uint64 bodyAddress = GeneraterMgr.m_vecCodeList.size();
     for (auto& pNode : m_vecBlock) {
         pNode->Generate();
     }
@@ -278,7 +548,11 @@ void For::Generate()
     uint64 continueAddress = GeneraterMgr.m_vecCodeList.size();
     m_pExpression->Generate();
     GeneraterMgr.WriteCode(Instruction::PopOperand);
-    GeneraterMgr.WriteCode(Instruction::Jump, jumpAddress);
+    // The bottom test resolves names like the top one did, before the body declared its own
+    std::swap(symbolTable, GeneraterMgr.m_listSymbolStackTable.front());
+    m_pCondition->Generate();
+    std::swap(symbolTable, GeneraterMgr.m_listSymbolStackTable.front());
+    GeneraterMgr.WriteCode(Instruction::LoopJump, bodyAddress);
     GeneraterMgr.PatchAddress(conditionJump);
     GeneraterMgr.PopBlock();
 
@@ -319,6 +593,19 @@ std::string If::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void If::ForEachChild(const ChildVisitor& _visitor)
+{
+    for (uint64 i = 0; i < m_vecCondition.size(); ++i) {
+        _visitor.m_fnExpression(m_vecCondition[i]);
+        for (auto& pNode : m_vecBlocks[i]) {
+            _visitor.m_fnStatement(pNode);
+        }
+    }
+    for (auto& pNode : m_vecElseBlock) {
+        _visitor.m_fnStatement(pNode);
+    }
+}
+
 void If::Interpret()
 {
     for (uint64 i = 0; i < m_vecCondition.size(); i++) {
@@ -345,10 +632,34 @@ void If::Interpret()
 
 void If::Generate()
 {
+    // Mostly taken if/else : the else block goes first so the hot path runs without the Jump over it
+    const SiteProfile* pProfile = ProfileMgr.Find(this);
+    if (m_vecCondition.size() == 1 && m_vecElseBlock.empty() == false && 
+        pProfile && pProfile->m_iCount != 0 && pProfile->m_iTrue * 2 > pProfile->m_iCount) {
+        m_vecCondition[0]->Generate();
+        auto thenJump = GeneraterMgr.WriteCode(Instruction::LoopJump);
+        GeneraterMgr.TagSite(thenJump, this);
+        GeneraterMgr.PushBlock();
+        for (auto& pNode : m_vecElseBlock) {
+            pNode->Generate();
+        }
+        GeneraterMgr.PopBlock();
+        auto endJump = GeneraterMgr.WriteCode(Instruction::Jump);
+        GeneraterMgr.PatchAddress(thenJump);
+        GeneraterMgr.PushBlock();
+        for (auto& pNode : m_vecBlocks[0]) {
+            pNode->Generate();
+        }
+        GeneraterMgr.PopBlock();
+        GeneraterMgr.PatchAddress(endJump);
+        return;
+    }
+
     std::vector<uint64> vecJumpList;
     for (uint32 i = 0; i < m_vecCondition.size(); ++i) {
         m_vecCondition[i]->Generate();
         auto conditionJump = GeneraterMgr.WriteCode(Instruction::ConditionJump);
+        GeneraterMgr.TagSite(conditionJump, this, i);
         GeneraterMgr.PushBlock();
         for (auto& pNode : m_vecBlocks[i]) {
             pNode->Generate();
@@ -383,6 +694,13 @@ std::string Variable::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void Variable::ForEachChild(const ChildVisitor& _visitor)
+{
+    if (m_pExpression) {
+        _visitor.m_fnExpression(m_pExpression);
+    }
+}
+
 void Variable::Interpret()
 {
     InterpreterMgr.m_listLocalFrame.back().front()[m_strName] = m_pExpression->Interpret();
@@ -408,27 +726,21 @@ std::string Print::PrintInfo(int32 _depth)
     return strResult;
 }
 
-void Print::Interpret()
+void Print::ForEachChild(const ChildVisitor& _visitor)
 {
-#ifdef USE_APPLICATION_IMGUI
     for (auto& pNode : m_vecArgument) {
-        auto anyValue = pNode->Interpret();
-        string strResult = AnyToString(anyValue);
-        strResult = std::regex_replace(strResult, std::regex("\\\\n"), "\n");
-        ImGui::Text(strResult.c_str());
-    }
-    if (m_bLineFeed) {
-        ImGui::Text("");
+        _visitor.m_fnExpression(pNode);
     }
-#else
+}
+
+void Print::Interpret()
+{
     for (auto& pNode : m_vecArgument) {
-        auto anyValue = pNode->Interpret();
-        std::cout << anyValue;
+        InterpreterMgr.m_strOutput += AnyToString(pNode->Interpret());
     }
     if (m_bLineFeed) {
-        std::cout << endl;
+        InterpreterMgr.m_strOutput += '\n';
     }
-#endif
 }
 
 void Print::Generate()
@@ -452,6 +764,13 @@ std::string Return::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void Return::ForEachChild(const ChildVisitor& _visitor)
+{
+    if (m_pExpression) {
+        _visitor.m_fnExpression(m_pExpression);
+    }
+}
+
 void Return::Interpret()
 {
     throw ReturnException{ m_pExpression->Interpret() };
@@ -459,7 +778,18 @@ void Return::Interpret()
 
 void Return::Generate()
 {
+    // Inside an inlined body the value is left on the stack as the result of the Call
+    if (GeneraterMgr.m_vecInlineReturnStack.empty() == false) {
+        m_pExpression->Generate();
+        GeneraterMgr.m_vecInlineReturnStack.back().push_back(GeneraterMgr.WriteCode(Instruction::Jump));
+        return;
+    }
+    // A tail call would return the callee's result without storing it
+    GeneraterMgr.m_bTailCall = GeneraterMgr.m_bMemo == false && std::dynamic_pointer_cast<Call>(m_pExpression) != nullptr;
     m_pExpression->Generate();
+    if (GeneraterMgr.m_bMemo) {
+        GeneraterMgr.WriteCode(Instruction::MemoStore, GeneraterMgr.m_iMemoSlot);
+    }
     GeneraterMgr.WriteCode(Instruction::Return);
 }
 
@@ -470,6 +800,10 @@ std::string Break::PrintInfo(int32 _depth)
     return Indent(_depth) + "BREAK\n";
 }
 
+void Break::ForEachChild(const ChildVisitor& _visitor)
+{
+}
+
 void Break::Interpret()
 {
     throw BreakException();
@@ -491,6 +825,10 @@ std::string Continue::PrintInfo(int32 _depth)
     return Indent(_depth) + "CONTINUE\n";
 }
 
+void Continue::ForEachChild(const ChildVisitor& _visitor)
+{
+}
+
 void Continue::Interpret()
 {
     throw ContinueException();
@@ -515,6 +853,11 @@ std::string ExpressionStatement::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void ExpressionStatement::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pExpression);
+}
+
 void ExpressionStatement::Interpret()
 {
     m_pExpression->Interpret();
@@ -541,6 +884,12 @@ std::string Or::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void Or::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pLhs);
+    _visitor.m_fnExpression(m_pRhs);
+}
+
 std::any Or::Interpret()
 {
     return Object::IsTrue(m_pLhs->Interpret()) ? true : m_pRhs->Interpret();;
@@ -569,6 +918,12 @@ std::string And::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void And::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pLhs);
+    _visitor.m_fnExpression(m_pRhs);
+}
+
 std::any And::Interpret()
 {
     return Object::IsFalse(m_pLhs->Interpret()) ? false : m_pRhs->Interpret();
@@ -600,101 +955,22 @@ std::string Relational::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void Relational::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pLhs);
+    _visitor.m_fnExpression(m_pRhs);
+}
+
 std::any Relational::Interpret()
 {
     auto lValue = m_pLhs->Interpret();
     auto rValue = m_pRhs->Interpret();
-
-    auto IsFunc = [&lValue, &rValue](std::function<bool(std::any)> _isFunc) {
-        if (_isFunc(lValue) && _isFunc(rValue)) {
-            return true;
-        }
-        return false;
-    };
-    auto IsCrossFunc = [&lValue, &rValue](std::function<bool(std::any)> _isFunc1, std::function<bool(std::any)> _isFunc2) {
-        if (_isFunc1(lValue) && _isFunc2(rValue)) {
-            return 1;
-        }
-        if (_isFunc2(lValue) && _isFunc1(rValue)) {
-            return 2;
-        }
-        return 0;
-    };
-
-    if (m_eKind == EKind::Equal) {
-        if (IsFunc(Object::IsNull)) {
-            return true;
-        }
-        if (IsFunc(Object::IsBoolean)) {
-            return Object::ToBoolean(lValue) == Object::ToBoolean(rValue);
-        }
-        if (IsFunc(Object::IsNumber)) {
-            return Object::ToNumber(lValue) == Object::ToNumber(rValue);
-        }
-        if (IsFunc(Object::IsFloat)) {
-            return Object::ToFloat(lValue) == Object::ToFloat(rValue);
-        }
-        if (IsFunc(Object::IsString)) {
-            return Object::ToString(lValue) == Object::ToString(rValue);
-        }
-
-        switch (int32 ret = IsCrossFunc(Object::IsNumber, Object::IsFloat)) {
-            case 1: return Object::ToNumber(lValue) == Object::ToFloat(rValue);
-            case 2: return Object::ToFloat(lValue) == Object::ToNumber(rValue);
-        }
-
-        switch (int32 ret = IsCrossFunc(Object::IsNumber, Object::IsString)) {
-            case 1: return std::to_string(Object::ToNumber(lValue)) == Object::ToString(rValue);
-            case 2: return Object::ToString(lValue) == std::to_string(Object::ToNumber(rValue));
-        }
-    }
-
-    if (m_eKind == EKind::NotEqual) {
-        if (IsFunc(Object::IsNull)) {
-            return false;
-        }
-        if (Object::IsNull(lValue) || Object::IsNull(rValue)) {
-            return true;
-        }
-        if (IsFunc(Object::IsBoolean)) {
-            return Object::ToBoolean(lValue) != Object::ToBoolean(rValue);
-        }
-        if (IsFunc(Object::IsNumber)) {
-            return Object::ToNumber(lValue) != Object::ToNumber(rValue);
-        }
-        if (IsFunc(Object::IsString)) {
-            return Object::ToString(lValue) != Object::ToString(rValue);
-        }
-
-        switch (int32 ret = IsCrossFunc(Object::IsNumber, Object::IsFloat)) {
-        case 1: return Object::ToNumber(lValue) != Object::ToFloat(rValue);
-        case 2: return Object::ToFloat(lValue) != Object::ToNumber(rValue);
-        }
-
-        switch (int32 ret = IsCrossFunc(Object::IsNumber, Object::IsString)) {
-        case 1: return std::to_string(Object::ToNumber(lValue)) != Object::ToString(rValue);
-        case 2: return Object::ToString(lValue) != std::to_string(Object::ToNumber(rValue));
-        }
-    }
-
-    if (m_eKind == EKind::LessThan && IsFunc(Object::IsNumber)) {
-        return Object::ToNumber(lValue) < Object::ToNumber(rValue);
-    }
-    if (m_eKind == EKind::GreaterThan && IsFunc(Object::IsNumber)) {
-        return Object::ToNumber(lValue) > Object::ToNumber(rValue);
-    }
-    if (m_eKind == EKind::LessOrEqual && IsFunc(Object::IsNumber)) {
-        return Object::ToNumber(lValue) <= Object::ToNumber(rValue);
-    }
-    if (m_eKind == EKind::GreaterOrEqual && IsFunc(Object::IsNumber)) {
-        return Object::ToNumber(lValue) >= Object::ToNumber(rValue);
-    }
-    return false;
+    return m_operatorCache.Operate(ToOperator(m_eKind), lValue, rValue);
 }
 
 void Relational::Generate()
 {
-    static std::map<EKind, Instruction> mapKindToInstructionTable = {
+    static const std::map<EKind, Instruction> mapKindToInstructionTable = {
         { EKind::Equal,             Instruction::Equal },   
         { EKind::NotEqual,          Instruction::NotEqual },
         { EKind::LessThan,          Instruction::LessThan },
@@ -705,7 +981,8 @@ void Relational::Generate()
 
     m_pLhs->Generate();
     m_pRhs->Generate();
-    GeneraterMgr.WriteCode(mapKindToInstructionTable[m_eKind]);
+    auto code = WriteTypedCode(mapKindToInstructionTable.at(m_eKind), this, m_pLhs.get(), m_pRhs.get());
+    GeneraterMgr.TagSite(code, this);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -723,56 +1000,22 @@ std::string Arithmetic::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void Arithmetic::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pLhs);
+    _visitor.m_fnExpression(m_pRhs);
+}
+
 std::any Arithmetic::Interpret()
 {
     auto lValue = m_pLhs->Interpret();
     auto rValue = m_pRhs->Interpret();
-    
-    auto IsFunc = [&lValue, &rValue](std::function<bool(std::any)> _isFunc) {
-        if (_isFunc(lValue) && _isFunc(rValue)) {
-            return true;
-        }
-        return false;
-        };
-
-    if (m_eKind == EKind::Add && IsFunc(Object::IsNumber)) {
-        return Object::ToNumber(lValue) + Object::ToNumber(rValue);
-    }
-    if (m_eKind == EKind::Add && IsFunc(Object::IsString)) {
-        return Object::ToString(lValue) + Object::ToString(rValue);
-    }   
-    if (m_eKind == EKind::Subtract && IsFunc(Object::IsNumber)) {
-        return Object::ToNumber(lValue) - Object::ToNumber(rValue);
-    }
-    if (m_eKind == EKind::Multiply) {
-        if (IsFunc(Object::IsNumber)) {
-            return Object::ToNumber(lValue) * Object::ToNumber(rValue);
-        }
-        else if (Object::IsString(lValue) && Object::IsNumber(rValue)) {
-            // python ó ڿ Ѵ.
-            std::string result;
-            std::string temp = Object::ToString(lValue);
-            uint64 size = Object::ToNumber(rValue);
-            result.reserve(temp.length() * size);
-            for (uint64 i = 0; i < size; ++i) {
-                result += temp;
-            }
-            return result;
-        }
-    }
-    if (m_eKind == EKind::Divide && IsFunc(Object::IsNumber)) {
-        return Object::ToNumber(rValue) == 0 ? 0.0 : Object::ToNumber(lValue) / Object::ToNumber(rValue);
-    }
-    if (m_eKind == EKind::Modulo && IsFunc(Object::IsNumber)) {
-        return Object::ToNumber(rValue) == 0 ? Object::ToNumber(lValue) : 
-            fmod(Object::ToNumber(lValue), Object::ToNumber(rValue));
-    }
-    return 0.0;
+    return m_operatorCache.Operate(ToOperator(m_eKind), lValue, rValue);
 }
 
 void Arithmetic::Generate()
 {
-    static std::map<EKind, Instruction> mapKindToInstructionTable = {
+    static const std::map<EKind, Instruction> mapKindToInstructionTable = {
         { EKind::Add,           Instruction::Add },   
         { EKind::Subtract,      Instruction::Subtract },
         { EKind::Multiply,      Instruction::Multiply },
@@ -781,7 +1024,8 @@ void Arithmetic::Generate()
     };
     m_pLhs->Generate();
     m_pRhs->Generate();
-    GeneraterMgr.WriteCode(mapKindToInstructionTable[m_eKind]);
+    auto code = WriteTypedCode(mapKindToInstructionTable.at(m_eKind), this, m_pLhs.get(), m_pRhs.get());
+    GeneraterMgr.TagSite(code, this);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -794,11 +1038,17 @@ std::string Unary::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void Unary::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pSub);
+}
+
 std::any Unary::Interpret()
 {
     auto value = m_pSub->Interpret();
     if (m_eKind == EKind::Add && Object::IsNumber(value)) {
-        return std::abs((long)Object::ToNumber(value));
+        // Numbers are unsigned so absolute is the value itself, same as Instruction::Absolute
+        return Object::ToNumber(value);
     }
     if (m_eKind == EKind::Subtract && Object::IsNumber(value)) {
         return Object::ToNumber(value) * -1;
@@ -831,6 +1081,12 @@ std::string GetElement::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void GetElement::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pSub);
+    _visitor.m_fnExpression(m_pIndex);
+}
+
 std::any GetElement::Interpret()
 {
     auto object = m_pSub->Interpret();
@@ -848,7 +1104,8 @@ void GetElement::Generate()
 {
     m_pSub->Generate();
     m_pIndex->Generate();
-    GeneraterMgr.WriteCode(Instruction::GetElement);
+    GeneraterMgr.WriteCode(TypeInference::ToTypedInstruction(Instruction::GetElement, 
+        TypeInferenceMgr.TypeOf(m_pSub.get()), TypeInferenceMgr.TypeOf(m_pIndex.get())));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -869,6 +1126,13 @@ std::string SetElement::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void SetElement::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pSub);
+    _visitor.m_fnExpression(m_pIndex);
+    _visitor.m_fnExpression(m_pValue);
+}
+
 std::any SetElement::Interpret()
 {
     auto object = m_pSub->Interpret();
@@ -888,7 +1152,8 @@ void SetElement::Generate()
     m_pValue->Generate();
     m_pSub->Generate();
     m_pIndex->Generate();
-    GeneraterMgr.WriteCode(Instruction::SetElement);
+    GeneraterMgr.WriteCode(TypeInference::ToTypedInstruction(Instruction::SetElement, 
+        TypeInferenceMgr.TypeOf(m_pSub.get()), TypeInferenceMgr.TypeOf(m_pIndex.get())));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -911,6 +1176,14 @@ std::string Call::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void Call::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pSub);
+    for (auto& pNode : m_vecArgument) {
+        _visitor.m_fnExpression(pNode);
+    }
+}
+
 std::any Call::Interpret()
 {
     auto value = m_pSub->Interpret();
@@ -919,15 +1192,25 @@ std::any Call::Interpret()
         for (size_t i = 0; i < m_vecArgument.size(); i++) {
             values.push_back(m_vecArgument[i]->Interpret());
         }
-        return Object::ToBuiltinFunction(value)(values);
+        std::any result;
+        Object::ToBuiltinFunction(value)(NativeArgument(values.data(), values.size()), result);
+        return result;
     }
     if (Object::IsFunction(value) == false) {
         return nullptr;
     }
+    InterpreterMgr.Step();
+    // Extra arguments are still run but bound to nothing, missing ones are null, as in the Machine
+    auto& vecParameter = Object::ToFunction(value)->m_vecParameter;
     std::map<std::string, std::any> mapParameter;
     for (size_t i = 0; i < m_vecArgument.size(); i++) {
-        auto name = Object::ToFunction(value)->m_vecParameter[i];
-        mapParameter[name] = m_vecArgument[i]->Interpret();
+        auto anyArgument = m_vecArgument[i]->Interpret();
+        if (i < vecParameter.size()) {
+            mapParameter[vecParameter[i]] = anyArgument;
+        }
+    }
+    for (size_t i = m_vecArgument.size(); i < vecParameter.size(); i++) {
+        mapParameter[vecParameter[i]] = nullptr;
     }
     InterpreterMgr.m_listLocalFrame.emplace_back().push_front(mapParameter);
     try {
@@ -943,11 +1226,32 @@ std::any Call::Interpret()
 
 void Call::Generate()
 {
+    bool bTailCall = std::exchange(GeneraterMgr.m_bTailCall, false);
+    auto pGetVariable = std::dynamic_pointer_cast<GetVariable>(m_pSub);
+    if (pGetVariable && GeneraterMgr.GetLocal(pGetVariable->m_strName) == SIZE_MAX &&
+        GeneraterMgr.GenerateInline(pGetVariable->m_strName, m_vecArgument, bTailCall, this)) {
+        return;
+    }
+    Instruction intrinsic;
+    uint64 native = 0;
+    bool bGlobal = pGetVariable && GeneraterMgr.GetLocal(pGetVariable->m_strName) == SIZE_MAX;
+    bool bIntrinsic = bGlobal && GeneraterMgr.FindIntrinsic(pGetVariable->m_strName, m_vecArgument.size(), intrinsic);
+    bool bNative = bGlobal && bIntrinsic == false && GeneraterMgr.FindNative(pGetVariable->m_strName, m_vecArgument.size(), native);
     for (uint64 i = m_vecArgument.size(); i > 0; --i) {
         m_vecArgument[i - 1]->Generate();
     }
+    if (bIntrinsic) {
+        GeneraterMgr.WriteCode(intrinsic);
+        return;
+    }
+    if (bNative) {
+        GeneraterMgr.WriteCode(Instruction::CallNative, native);
+        return;
+    }
     m_pSub->Generate();
-    GeneraterMgr.WriteCode(Instruction::Call, m_vecArgument.size());
+    // return f(...) reuses the frame, the Return after it is still needed for callees that are not script functions
+    auto code = GeneraterMgr.WriteCode(bTailCall ? Instruction::TailCall : Instruction::Call, m_vecArgument.size());
+    GeneraterMgr.TagSite(code, this);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -957,6 +1261,10 @@ std::string NullLiteral::PrintInfo(int32 _depth)
     return Indent(_depth) + "null\n";
 }
 
+void NullLiteral::ForEachChild(const ChildVisitor& _visitor)
+{
+}
+
 std::any NullLiteral::Interpret()
 {
     return nullptr;
@@ -974,6 +1282,10 @@ std::string BooleanLiteral::PrintInfo(int32 _depth)
     return Indent(_depth) + (m_bValue ? "true\n" : "false\n");
 }
 
+void BooleanLiteral::ForEachChild(const ChildVisitor& _visitor)
+{
+}
+
 std::any BooleanLiteral::Interpret()
 {
     return m_bValue;
@@ -981,7 +1293,7 @@ std::any BooleanLiteral::Interpret()
 
 void BooleanLiteral::Generate()
 {
-    GeneraterMgr.WriteCode(Instruction::PushBoolean);
+    GeneraterMgr.WriteCode(Instruction::PushBoolean, m_bValue);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -991,6 +1303,10 @@ std::string NumberLiteral::PrintInfo(int32 _depth)
     return Indent(_depth) + std::to_string(m_uValue);
 }
 
+void NumberLiteral::ForEachChild(const ChildVisitor& _visitor)
+{
+}
+
 std::any NumberLiteral::Interpret()
 {
     return m_uValue;
@@ -1008,6 +1324,10 @@ std::string FloatLiteral::PrintInfo(int32 _depth)
     return Indent(_depth) + std::to_string(m_dValue);
 }
 
+void FloatLiteral::ForEachChild(const ChildVisitor& _visitor)
+{
+}
+
 std::any FloatLiteral::Interpret()
 {
     return m_dValue;
@@ -1025,6 +1345,10 @@ std::string StringLiteral::PrintInfo(int32 _depth)
     return Indent(_depth) + "\"" + m_strValue + "\"\n";
 }
 
+void StringLiteral::ForEachChild(const ChildVisitor& _visitor)
+{
+}
+
 std::any StringLiteral::Interpret()
 {
     return m_strValue;
@@ -1048,6 +1372,13 @@ std::string ArrayLiteral::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void ArrayLiteral::ForEachChild(const ChildVisitor& _visitor)
+{
+    for (auto& pNode : m_vecValue) {
+        _visitor.m_fnExpression(pNode);
+    }
+}
+
 std::any ArrayLiteral::Interpret()
 {
     auto result = std::make_shared<Array>();
@@ -1062,7 +1393,7 @@ void ArrayLiteral::Generate()
     for (uint64 i = m_vecValue.size(); i > 0; --i) {
         m_vecValue[i - 1]->Generate();
     }
-    GeneraterMgr.WriteCode(Instruction::PushArray, m_vecValue.size());
+    GeneraterMgr.WriteCode(EscapeMgr.IsScoped(this) ? Instruction::PushScopedArray : Instruction::PushArray, m_vecValue.size());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1078,6 +1409,13 @@ std::string MapLiteral::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void MapLiteral::ForEachChild(const ChildVisitor& _visitor)
+{
+    for (auto& [key, pValue] : m_mapValue) {
+        _visitor.m_fnExpression(pValue);
+    }
+}
+
 std::any MapLiteral::Interpret()
 {
     auto result = std::make_shared<Map>();
@@ -1093,7 +1431,7 @@ void MapLiteral::Generate()
         GeneraterMgr.WriteCode(Instruction::PushString, key);
         pValue->Generate();
     }
-    GeneraterMgr.WriteCode(Instruction::PushMap, m_mapValue.size());
+    GeneraterMgr.WriteCode(EscapeMgr.IsScoped(this) ? Instruction::PushScopedMap : Instruction::PushMap, m_mapValue.size());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1103,6 +1441,10 @@ std::string GetVariable::PrintInfo(int32 _depth)
     return Indent(_depth) + "GET_VARIABLE: " + m_strName + "\n";
 }
 
+void GetVariable::ForEachChild(const ChildVisitor& _visitor)
+{
+}
+
 std::any GetVariable::Interpret()
 {
     for (auto& vecVariable : InterpreterMgr.m_listLocalFrame.back()) {
@@ -1116,8 +1458,8 @@ std::any GetVariable::Interpret()
     if (InterpreterMgr.m_mapFunctionTable.count(m_strName)) {
         return InterpreterMgr.m_mapFunctionTable[m_strName];
     }
-    if (InterpreterMgr.m_mapBuiltinFunctionTable.count(m_strName)) {
-        return InterpreterMgr.m_mapBuiltinFunctionTable[m_strName];
+    if (uint64 native = BuiltinMgr.Find(m_strName); native != SIZE_MAX) {
+        return BuiltinMgr.Get(native).m_function;
     }
     return nullptr;
 }
@@ -1142,6 +1484,11 @@ std::string SetVariable::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void SetVariable::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pValue);
+}
+
 std::any SetVariable::Interpret()
 {
     for (auto& variables : InterpreterMgr.m_listLocalFrame.back()) {
@@ -1159,11 +1506,7 @@ void SetVariable::Generate()
         GeneraterMgr.WriteCode(Instruction::SetGlobal, m_strName);
     }
     else {
-<<<<<<< HEAD
         GeneraterMgr.WriteCode(Instruction::SetLocal, GeneraterMgr.GetLocal(m_strName));
-=======
-        GeneraterMgr.WriteCode(Instruction::SetLocal, m_strName);
->>>>>>> 66dd2488c6dd53f5aae4938226249a18f7b8893b
     }
 }
 
@@ -1184,6 +1527,15 @@ std::string Class::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void Class::ForEachChild(const ChildVisitor& _visitor)
+{
+    for (auto& member : m_vecVariable) {
+        if (member.m_pVariable) {
+            _visitor.m_fnStatement(member.m_pVariable);
+        }
+    }
+}
+
 void Class::Interpret()
 {
     for (auto& pVariable : m_vecVariable)
@@ -1211,6 +1563,13 @@ std::string SetClassAccess::PrintInfo(int32 _depth)
     return std::string();
 }
 
+void SetClassAccess::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pSub);
+    _visitor.m_fnExpression(m_pMember);
+    _visitor.m_fnExpression(m_pValue);
+}
+
 std::any SetClassAccess::Interpret()
 {
     return 1;
@@ -1230,6 +1589,12 @@ std::string GetClassAccess::PrintInfo(int32 _depth)
     return strResult;
 }
 
+void GetClassAccess::ForEachChild(const ChildVisitor& _visitor)
+{
+    _visitor.m_fnExpression(m_pSub);
+    _visitor.m_fnExpression(m_pMember);
+}
+
 std::any GetClassAccess::Interpret()
 {
     return m_pSub->Interpret();
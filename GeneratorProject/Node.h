@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 #include <any>
@@ -10,10 +11,19 @@
 #include "TypeDefine.h"
 #include "Token.h"
 #include "Code.h"
+#include "Operator.h"
 
 class Class;
 class Function;
 class Program;
+class Statement;
+class Expression;
+struct ClosureFrame;
+struct SSAValue;
+enum class EFlow;
+
+using ExpressionClosure = std::function<std::any(ClosureFrame&)>;
+using StatementClosure = std::function<EFlow(ClosureFrame&)>;
 
 enum class EMemberAccess
 {
@@ -24,18 +34,35 @@ enum class EMemberAccess
 	Max
 };
 
-class Interpreter
+enum class EInterpretMode
 {
-public:
-	using ScriptFunctionType = std::function<std::any(std::vector<std::any>)>;
+	Tree,
+	Closure,
+};
 
+enum class EGenerateMode
+{
+	Tree,
+	SSA,
+};
+
+// inline/noinline written before function, memo may come with either
+enum class EInlineHint
+{
+	Default,	// inlined when the body fits Generater::m_iInlineBudget
+	Always,
+	Never,
+};
+
+class Interpreter
+{
 private:
-	Interpreter();
+	Interpreter() { }
 	~Interpreter() { }
 public:
 	static Interpreter& GetInstance()
 	{
-		static Interpreter instance;
+		static thread_local Interpreter instance;
 		return instance;
 	}
 #define InterpreterMgr	Interpreter::GetInstance()
@@ -43,12 +70,25 @@ public:
 public:
 	//  
 	void Interpret(std::shared_ptr<Program> _pProgram);
+	// One call run on its own globals and frames for compile time evaluation,
+	// false when it runs past m_iStepLimit calls and loop iterations or m_iDepthLimit frames
+	bool Evaluate(std::shared_ptr<Function> _pFunction, const std::vector<std::any>& _vecArgument,
+		const std::map<std::string, std::shared_ptr<Function>>& _mapFunction, std::any& _anyResult);
+	// Counts a call or loop iteration against the budget Evaluate sets, free otherwise
+	void Step();
 public:
 	std::map<std::string, std::any> m_mapGlobal;
 	std::list<std::list<std::map<std::string, std::any>>> m_listLocalFrame;
 	std::map<std::string, std::shared_ptr<Function>> m_mapFunctionTable;
-	std::map<std::string, ScriptFunctionType> m_mapBuiltinFunctionTable;
 	std::map<std::string, std::vector<std::tuple<EMemberAccess, std::any>>> m_mapClassDefaultTable;
+	// Closure : compile the tree once into closures and run those
+	EInterpretMode m_eMode = EInterpretMode::Tree;
+	uint64 m_iStepLimit = 100000;
+	uint64 m_iDepthLimit = 200;
+	// Steps left in the running Evaluate, zero outside of one
+	uint64 m_iStepBudget = 0;
+	// Text of Print since the last Interpret, the UI thread shows it, closure mode prints to ClosureCompiler's
+	std::string m_strOutput;
 };
 
 class Generater
@@ -60,7 +100,7 @@ private:
 public:
 	static Generater& GetInstance()
 	{
-		static Generater instance;
+		static thread_local Generater instance;
 		return instance;
 	}
 #define GeneraterMgr		Generater::GetInstance()
@@ -68,6 +108,14 @@ public:
 	// ڵ 
 	auto Generate(std::shared_ptr<Program> _pProgram) -> std::tuple<std::vector<Code>, std::map<std::string, std::size_t>>;
 
+	// Generate split up so functions can be fed one by one as they are parsed
+	void BeginGenerate();
+	void GenerateFunction(std::shared_ptr<Function> _pFunction);
+	auto EndGenerate() -> std::tuple<std::vector<Code>, std::map<std::string, std::size_t>>;
+	// GenerateFunction in two halves, the whole program optimizes every body before it emits any
+	void OptimizeFunction(std::shared_ptr<Function> _pFunction);
+	void EmitFunction(std::shared_ptr<Function> _pFunction);
+
 public:
 	void SetLocal(std::string _strLocal);
 	uint64 GetLocal(std::string _strLocal);
@@ -78,6 +126,18 @@ public:
 	uint64 WriteCode(Instruction _instruction, std::any _anyValue);
 	void PatchAddress(uint64 _codeIndex);
 	void PatchOperand(uint64 _codeIndex, uint64 _operand);
+	// Marks the code as generated for a profile site of the node
+	void TagSite(uint64 _codeIndex, const void* _pNode, uint64 _offset = 0);
+	// Emits the body of a script function in place of a Call, false leaves nothing written
+	// In tail position the body's Returns stay real Returns of the function being generated
+	bool GenerateInline(const std::string& _strName, std::vector<std::shared_ptr<Expression>>& _vecArgument, bool _bTailCall,
+		const Expression* _pCallSite = nullptr);
+	std::string PrintInlineReport();
+	// Instruction a call of the builtin takes the place of, false when the name or argument count has none
+	// or a script function or an assignment may be using the name
+	bool FindIntrinsic(const std::string& _strName, uint64 _argumentCount, Instruction& _instruction) const;
+	// Index in Builtin a call is linked to as CallNative, same conditions as FindIntrinsic
+	bool FindNative(const std::string& _strName, uint64 _argumentCount, uint64& _index) const;
 
 public:
 	std::vector<Code> m_vecCodeList;
@@ -87,6 +147,26 @@ public:
 	uint64 m_iLocalSize = 0;
 	std::vector<std::vector<uint64>> m_vecContinueStack;
 	std::vector<std::vector<uint64>> m_vecBreakStack;
+	// SSA : functions go through SSAGenerater, falling back to Function::Generate when unsupported
+	EGenerateMode m_eMode = EGenerateMode::Tree;
+	// Every script function, only known when Generate gets the whole Program up front
+	std::set<std::string> m_setFunctionName;
+	bool m_bWholeProgram = false;
+	// Inlining : functions that can be inlined, the function being generated followed by the ones inlined into it,
+	// the Jump of each Return per inlined body and caller -> callee -> times inlined
+	std::map<std::string, std::shared_ptr<Function>> m_mapInlineCandidate;
+	std::vector<std::string> m_vecInlineStack;
+	std::vector<std::vector<uint64>> m_vecInlineReturnStack;
+	std::map<std::string, std::map<std::string, uint64>> m_mapInlineCount;
+	// Instructions a Default body may take, and the deepest chain of bodies inlined into each other
+	uint64 m_iInlineBudget = 32;
+	uint64 m_iInlineDepth = 4;
+	// Set by Return for the Call it returns, taken by that Call before its arguments are generated
+	bool m_bTailCall = false;
+	// The function being generated caches its results, every real Return stores into the table first
+	// with the key MemoLoad left in the hidden local m_iMemoSlot
+	bool m_bMemo = false;
+	uint64 m_iMemoSlot = 0;
 };
 
 class Program 
@@ -96,12 +176,24 @@ public:
 	std::vector<std::shared_ptr<Class>> m_vecClass;
 };
 
+// Callbacks for the direct children of a node, for passes that only need the shape of the tree
+struct ChildVisitor
+{
+public:
+	std::function<void(const std::shared_ptr<Statement>&)> m_fnStatement;
+	std::function<void(const std::shared_ptr<Expression>&)> m_fnExpression;
+};
+
 class Statement 
 {
 public:
 	virtual std::string PrintInfo(int32 _depth) = 0;
 	virtual void Interpret() = 0;
 	virtual void Generate() = 0;
+	virtual StatementClosure Compile() = 0;
+	virtual void Optimize() = 0;
+	virtual void BuildSSA() = 0;
+	virtual void ForEachChild(const ChildVisitor& _visitor) = 0;
 };
 
 class Expression 
@@ -110,6 +202,12 @@ public:
 	virtual std::string PrintInfo(int32 _depth) = 0;
 	virtual std::any Interpret() = 0;
 	virtual void Generate() = 0;
+	virtual ExpressionClosure Compile() = 0;
+	// Returns the folded replacement, nullptr keeps this node
+	virtual std::shared_ptr<Expression> Optimize() = 0;
+	// Emits into SSAMgr's current block and returns the value of the expression
+	virtual SSAValue* BuildSSA() = 0;
+	virtual void ForEachChild(const ChildVisitor& _visitor) = 0;
 };
 
 class Function : public Statement 
@@ -118,11 +216,18 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::string m_strName;
 	std::vector<std::string> m_vecParameter;
 	std::vector<std::shared_ptr<Statement>> m_vecBlock;
+	EInlineHint m_eInline = EInlineHint::Default;
+	// Results cached by the Machine per argument values, kept only when Evaluator proves the function pure
+	bool m_bMemo = false;
 };
 
 class Variable : public Statement 
@@ -131,6 +236,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::string m_strName;
@@ -144,6 +253,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::shared_ptr<Expression> m_pExpression;
@@ -155,6 +268,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::shared_ptr<Variable> m_pVariable;
@@ -169,6 +286,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 };
 
 class Continue : public Statement 
@@ -177,6 +298,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 };
 
 class If : public Statement 
@@ -185,6 +310,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::vector<std::shared_ptr<Expression>> m_vecCondition;
@@ -198,6 +327,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:	
 	bool m_bLineFeed = false;
@@ -210,6 +343,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::shared_ptr<Expression> m_pExpression;
@@ -221,6 +358,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::shared_ptr<Expression> m_pLhs;
@@ -233,6 +374,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::shared_ptr<Expression> m_pLhs;
@@ -245,11 +390,16 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	EKind m_eKind = EKind::Unknown;
 	std::shared_ptr<Expression> m_pLhs;
 	std::shared_ptr<Expression> m_pRhs;
+	OperatorCache m_operatorCache;
 };
 
 class Arithmetic : public Expression
@@ -258,11 +408,16 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	EKind m_eKind = EKind::Unknown;
 	std::shared_ptr<Expression> m_pLhs;
 	std::shared_ptr<Expression> m_pRhs;
+	OperatorCache m_operatorCache;
 };
 
 class Unary : public Expression
@@ -271,6 +426,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	EKind m_eKind = EKind::Unknown;
@@ -283,6 +442,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::shared_ptr<Expression> m_pSub;
@@ -295,6 +458,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::shared_ptr<Expression> m_pSub;
@@ -307,6 +474,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::shared_ptr<Expression> m_pSub;
@@ -320,6 +491,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::string m_strName;
@@ -331,6 +506,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::string m_strName;
@@ -343,6 +522,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 };
 
 class BooleanLiteral : public Expression
@@ -351,6 +534,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	bool m_bValue = false;
@@ -362,6 +549,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	uint64 m_uValue = 0;
@@ -373,6 +564,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	float64 m_dValue = 0.0;
@@ -384,6 +579,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::string m_strValue;
@@ -395,6 +594,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::vector<std::shared_ptr<Expression>> m_vecValue;
@@ -406,6 +609,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::map<std::string, std::shared_ptr<Expression>> m_mapValue;
@@ -424,6 +631,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	void Interpret() override;
 	void Generate() override;
+	StatementClosure Compile() override;
+	void Optimize() override;
+	void BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::string m_strName;
@@ -436,6 +647,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 
 public:
 	std::shared_ptr<Expression> m_pSub;
@@ -450,6 +665,10 @@ public:
 	std::string PrintInfo(int32 _depth) override;
 	std::any Interpret() override;
 	void Generate() override;
+	ExpressionClosure Compile() override;
+	std::shared_ptr<Expression> Optimize() override;
+	SSAValue* BuildSSA() override;
+	void ForEachChild(const ChildVisitor& _visitor) override;
 	
 public:
 	std::shared_ptr<Expression> m_pSub;
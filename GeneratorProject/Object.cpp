@@ -1,4 +1,5 @@
 #include <iomanip>
+#include <sstream>
 #include <iostream>
 #include "TypeDefine.h"
 #include <cmath>
@@ -13,48 +14,6 @@ using std::string;
 using std::vector;
 using std::function;
 
-map<string, function<any(vector<any>)>> builtinFunctionTable = {
-  {"length", [](vector<any> values)->any {
-	if (values.size() == 1 && Object::IsArray(values[0])) {
-		return static_cast<float64>(Object::ToArray(values[0])->m_vecValue.size());
-	}
-	if (values.size() == 1 && Object::IsMap(values[0])) {
-		return static_cast<float64>(Object::ToMap(values[0])->m_mapValue.size());
-	}
-	return 0.0;
-  }},
-  {"push", [](vector<any> values)->any {
-	if (values.size() == 2 && Object::IsArray(values[0])) {
-	  Object::ToArray(values[0])->m_vecValue.push_back(values[1]);
-	  return values[0];
-	}
-	return nullptr;
-  }},
-  {"pop", [](vector<any> values)->any {
-	if (values.size() == 1 && Object::IsArray(values[0]) && Object::ToArray(values[0])->m_vecValue.size() != 0) {
-	  auto result = Object::ToArray(values[0])->m_vecValue.back();
-	  Object::ToArray(values[0])->m_vecValue.pop_back();
-	  return result;
-	}
-	return nullptr;
-  }},
-  {"erase", [](vector<any> values)->any {
-	if (values.size() == 2 && Object::IsMap(values[0]) && Object::IsString(values[1]) &&
-		Object::ToMap(values[0])->m_mapValue.count(Object::ToString(values[1]))) {
-	  auto result = Object::ToMap(values[0])->m_mapValue.at(Object::ToString(values[1]));
-	  Object::ToMap(values[0])->m_mapValue.erase(Object::ToString(values[1]));
-	  return result;
-	}
-	return nullptr;
-  }},
-  {"clock", [](vector<any> values)->any {
-	return static_cast<float64>(clock());
-  }},
-  {"sqrt", [](vector<any> values)->any {
-	return sqrt(Object::ToNumber(values[0]));
-  }},
-};
-
 bool Object::IsSize(std::any _anyValue)
 {
 	return _anyValue.type() == typeid(size_t);
@@ -184,12 +143,12 @@ std::shared_ptr<Function> Object::ToFunction(std::any _anyValue)
 
 bool Object::IsBuiltinFunction(std::any _anyValue)
 {
-	return _anyValue.type() == typeid(std::function<std::any(std::vector<std::any>)>);
+	return _anyValue.type() == typeid(NativeFunction);
 }
 
-std::function<std::any(std::vector<std::any>)> Object::ToBuiltinFunction(std::any _anyValue)
+NativeFunction Object::ToBuiltinFunction(std::any _anyValue)
 {
-	return std::any_cast<std::function<std::any(std::vector<std::any>)>>(_anyValue);
+	return std::any_cast<NativeFunction>(_anyValue);
 }
 
 std::string AnyToString(std::any _anyValue)
@@ -204,6 +163,11 @@ std::string AnyToString(std::any _anyValue)
 	else if (Object::IsNumber(_anyValue)) {
 		strResult = std::to_string(Object::ToNumber(_anyValue));
 	}
+	else if (Object::IsFloat(_anyValue)) {
+		std::ostringstream stream;
+		stream << Object::ToFloat(_anyValue);
+		strResult = stream.str();
+	}
 	else if (Object::IsString(_anyValue)) {
 		strResult = Object::ToString(_anyValue);
 	}
@@ -233,7 +197,10 @@ std::ostream& operator<<(ostream& _os, any& _anyValue)
 		_os << std::boolalpha << std::any_cast<bool>(_anyValue);
 	}
 	else if (Object::IsNumber(_anyValue)) {
-		printf("%g", Object::ToNumber(_anyValue));
+		_os << Object::ToNumber(_anyValue);
+	}
+	else if (Object::IsFloat(_anyValue)) {
+		_os << Object::ToFloat(_anyValue);
 	}
 	else if (Object::IsString(_anyValue)) {
 		_os << Object::ToString(_anyValue);
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <functional>
 #include "Node.h"
+#include "Builtin.h"
 
 using std::any;
 using std::map;
@@ -19,7 +20,9 @@ struct Map;
 
 struct Object 
 {
-	bool m_bMarked = false;
+	// Collection of the owning machine that last reached the object, scoped objects are never swept
+	// so a mark has to go stale on its own rather than be cleared
+	uint64 m_iMark = 0;
 	virtual ~Object() {}
 
 	static bool IsSize(std::any _anyValue);
@@ -46,7 +49,7 @@ struct Object
 	static bool IsFunction(std::any _anyValue);
 	static std::shared_ptr<Function> ToFunction(std::any _anyValue);
 	static bool IsBuiltinFunction(std::any _anyValue);
-	static std::function<std::any(std::vector<std::any>)> ToBuiltinFunction(std::any _anyValue);
+	static NativeFunction ToBuiltinFunction(std::any _anyValue);
 };
 
 struct Array : Object 
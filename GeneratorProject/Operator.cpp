@@ -0,0 +1,230 @@
+#include <array>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <type_traits>
+#include <iostream>
+#include "Operator.h"
+
+namespace
+{
+    constexpr uint64 TypeCount = static_cast<uint64>(EValueType::Count);
+    constexpr uint64 OperatorCount = static_cast<uint64>(EOperator::Count);
+
+    template<typename T>
+    const T& As(const std::any& _anyValue)
+    {
+        return *std::any_cast<T>(&_anyValue);
+    }
+
+    constexpr bool IsArithmetic(EOperator _eOperator)
+    {
+        return _eOperator <= EOperator::Modulo;
+    }
+
+    constexpr bool IsEquality(EOperator _eOperator)
+    {
+        return _eOperator == EOperator::Equal || _eOperator == EOperator::NotEqual;
+    }
+
+    constexpr bool IsNumeric(EValueType _eType)
+    {
+        return _eType == EValueType::Number || _eType == EValueType::Float;
+    }
+
+    template<EValueType Type>
+    float64 ToFloat(const std::any& _anyValue)
+    {
+        if constexpr (Type == EValueType::Number) {
+            return static_cast<float64>(As<uint64>(_anyValue));
+        }
+        else {
+            return As<float64>(_anyValue);
+        }
+    }
+
+    template<EOperator Operator>
+    bool Compare(bool _bEqual)
+    {
+        return Operator == EOperator::Equal ? _bEqual : _bEqual == false;
+    }
+
+    // Number op Number stays a Number, any Float operand makes the result a Float
+    template<EOperator Operator, typename T>
+    std::any Calculate(T _lValue, T _rValue)
+    {
+        if constexpr (Operator == EOperator::Add)               { return _lValue + _rValue; }
+        if constexpr (Operator == EOperator::Subtract)          { return _lValue - _rValue; }
+        if constexpr (Operator == EOperator::Multiply)          { return _lValue * _rValue; }
+        if constexpr (Operator == EOperator::Divide)            { return _rValue == 0 ? T(0) : _lValue / _rValue; }
+        if constexpr (Operator == EOperator::Modulo) {
+            if constexpr (std::is_floating_point_v<T>) {
+                return _rValue == 0 ? _lValue : std::fmod(_lValue, _rValue);
+            }
+            else {
+                return _rValue == 0 ? _lValue : _lValue % _rValue;
+            }
+        }
+        if constexpr (Operator == EOperator::Equal)             { return _lValue == _rValue; }
+        if constexpr (Operator == EOperator::NotEqual)          { return _lValue != _rValue; }
+        if constexpr (Operator == EOperator::LessThan)          { return _lValue < _rValue; }
+        if constexpr (Operator == EOperator::GreaterThan)       { return _lValue > _rValue; }
+        if constexpr (Operator == EOperator::LessOrEqual)       { return _lValue <= _rValue; }
+        if constexpr (Operator == EOperator::GreaterOrEqual)    { return _lValue >= _rValue; }
+    }
+
+    template<EOperator Operator, EValueType Lhs, EValueType Rhs>
+    std::any Kernel(const std::any& _lValue, const std::any& _rValue)
+    {
+        if constexpr (Lhs == EValueType::Number && Rhs == EValueType::Number) {
+            return Calculate<Operator, uint64>(As<uint64>(_lValue), As<uint64>(_rValue));
+        }
+        else if constexpr (IsNumeric(Lhs) && IsNumeric(Rhs)) {
+            return Calculate<Operator, float64>(ToFloat<Lhs>(_lValue), ToFloat<Rhs>(_rValue));
+        }
+        else if constexpr (Lhs == EValueType::String && Rhs == EValueType::String && Operator == EOperator::Add) {
+            return As<std::string>(_lValue) + As<std::string>(_rValue);
+        }
+        else if constexpr (Lhs == EValueType::String && Rhs == EValueType::Number && Operator == EOperator::Multiply) {
+            // Repeats the string like python
+            const std::string& temp = As<std::string>(_lValue);
+            uint64 size = As<uint64>(_rValue);
+            std::string result;
+            result.reserve(temp.length() * size);
+            for (uint64 i = 0; i < size; ++i) {
+                result += temp;
+            }
+            return result;
+        }
+        else if constexpr (IsEquality(Operator)) {
+            if constexpr (Lhs == EValueType::Null || Rhs == EValueType::Null) {
+                return Compare<Operator>(Lhs == Rhs);
+            }
+            else if constexpr (Lhs == EValueType::Boolean && Rhs == EValueType::Boolean) {
+                return Compare<Operator>(As<bool>(_lValue) == As<bool>(_rValue));
+            }
+            else if constexpr (Lhs == EValueType::String && Rhs == EValueType::String) {
+                return Compare<Operator>(As<std::string>(_lValue) == As<std::string>(_rValue));
+            }
+            else if constexpr (Lhs == EValueType::Number && Rhs == EValueType::String) {
+                return Compare<Operator>(std::to_string(As<uint64>(_lValue)) == As<std::string>(_rValue));
+            }
+            else if constexpr (Lhs == EValueType::String && Rhs == EValueType::Number) {
+                return Compare<Operator>(As<std::string>(_lValue) == std::to_string(As<uint64>(_rValue)));
+            }
+            else {
+                return false;
+            }
+        }
+        else if constexpr (IsArithmetic(Operator)) {
+            return 0.0;
+        }
+        else {
+            return false;
+        }
+    }
+
+    using KernelRow = std::array<OperatorKernel, TypeCount * TypeCount>;
+
+    template<EOperator Operator, uint64... Index>
+    constexpr KernelRow MakeKernelRow(std::integer_sequence<uint64, Index...>)
+    {
+        return { &Kernel<Operator, static_cast<EValueType>(Index / TypeCount), static_cast<EValueType>(Index % TypeCount)>... };
+    }
+
+    template<uint64... Index>
+    constexpr std::array<KernelRow, OperatorCount> MakeKernelTable(std::integer_sequence<uint64, Index...>)
+    {
+        return { MakeKernelRow<static_cast<EOperator>(Index)>(std::make_integer_sequence<uint64, TypeCount * TypeCount>())... };
+    }
+
+    constexpr std::array<KernelRow, OperatorCount> g_kernelTable = MakeKernelTable(std::make_integer_sequence<uint64, OperatorCount>());
+}
+
+EValueType ToValueType(const std::any& _anyValue)
+{
+    const std::type_info& type = _anyValue.type();
+    if (type == typeid(uint64)) {
+        return EValueType::Number;
+    }
+    if (type == typeid(float64)) {
+        return EValueType::Float;
+    }
+    if (type == typeid(std::string)) {
+        return EValueType::String;
+    }
+    if (type == typeid(bool)) {
+        return EValueType::Boolean;
+    }
+    if (type == typeid(nullptr_t)) {
+        return EValueType::Null;
+    }
+    return EValueType::Object;
+}
+
+EOperator ToOperator(EKind _eKind)
+{
+    switch (_eKind) {
+    case EKind::Add:            return EOperator::Add;
+    case EKind::Subtract:       return EOperator::Subtract;
+    case EKind::Multiply:       return EOperator::Multiply;
+    case EKind::Divide:         return EOperator::Divide;
+    case EKind::Modulo:         return EOperator::Modulo;
+    case EKind::Equal:          return EOperator::Equal;
+    case EKind::NotEqual:       return EOperator::NotEqual;
+    case EKind::LessThan:       return EOperator::LessThan;
+    case EKind::GreaterThan:    return EOperator::GreaterThan;
+    case EKind::LessOrEqual:    return EOperator::LessOrEqual;
+    case EKind::GreaterOrEqual: return EOperator::GreaterOrEqual;
+    }
+    std::cout << ToString(_eKind) << " is not a binary operator.\n";
+    throw;
+}
+
+EOperator ToOperator(Instruction _instruction)
+{
+    switch (_instruction) {
+    case Instruction::Add:              return EOperator::Add;
+    case Instruction::Subtract:         return EOperator::Subtract;
+    case Instruction::Multiply:         return EOperator::Multiply;
+    case Instruction::Divide:           return EOperator::Divide;
+    case Instruction::Modulo:           return EOperator::Modulo;
+    case Instruction::Equal:            return EOperator::Equal;
+    case Instruction::NotEqual:         return EOperator::NotEqual;
+    case Instruction::LessThan:         return EOperator::LessThan;
+    case Instruction::GreaterThan:      return EOperator::GreaterThan;
+    case Instruction::LessOrEqual:      return EOperator::LessOrEqual;
+    case Instruction::GreaterOrEqual:   return EOperator::GreaterOrEqual;
+    }
+    std::cout << ToString(_instruction) << " is not a binary operator.\n";
+    throw;
+}
+
+OperatorKernel FindKernel(EOperator _eOperator, EValueType _eLhs, EValueType _eRhs)
+{
+    return g_kernelTable[static_cast<uint64>(_eOperator)][static_cast<uint64>(_eLhs) * TypeCount + static_cast<uint64>(_eRhs)];
+}
+
+std::any Operate(EOperator _eOperator, const std::any& _lValue, const std::any& _rValue)
+{
+    return FindKernel(_eOperator, ToValueType(_lValue), ToValueType(_rValue))(_lValue, _rValue);
+}
+
+std::any OperatorCache::Operate(EOperator _eOperator, const std::any& _lValue, const std::any& _rValue)
+{
+    if (m_pKernel != nullptr) {
+        if (_lValue.type() == *m_pLhsType && _rValue.type() == *m_pRhsType) {
+            return m_pKernel(_lValue, _rValue);
+        }
+        m_pKernel = nullptr;
+        m_bGeneric = true;
+    }
+
+    OperatorKernel pKernel = FindKernel(_eOperator, ToValueType(_lValue), ToValueType(_rValue));
+    if (m_bGeneric == false) {
+        m_pKernel = pKernel;
+        m_pLhsType = &_lValue.type();
+        m_pRhsType = &_rValue.type();
+    }
+    return pKernel(_lValue, _rValue);
+}
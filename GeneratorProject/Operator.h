@@ -0,0 +1,65 @@
+#pragma once
+
+#include <any>
+#include <typeinfo>
+#include "TypeDefine.h"
+#include "Token.h"
+#include "Code.h"
+
+// Value categories the binary kernels are specialized on, everything else is an Object
+enum class EValueType : uint8
+{
+	Null,
+	Boolean,
+	Number,
+	Float,
+	String,
+	Object,
+	Count
+};
+
+enum class EOperator : uint8
+{
+	Add,
+	Subtract,
+	Multiply,
+	Divide,
+	Modulo,
+	Equal,
+	NotEqual,
+	LessThan,
+	GreaterThan,
+	LessOrEqual,
+	GreaterOrEqual,
+	Count
+};
+
+using OperatorKernel = std::any(*)(const std::any&, const std::any&);
+
+EValueType ToValueType(const std::any& _anyValue);
+EOperator ToOperator(EKind _eKind);
+EOperator ToOperator(Instruction _instruction);
+OperatorKernel FindKernel(EOperator _eOperator, EValueType _eLhs, EValueType _eRhs);
+
+// Shared by the Interpreter, the closure compiler and the Machine
+std::any Operate(EOperator _eOperator, const std::any& _lValue, const std::any& _rValue);
+
+template<EOperator Operator>
+std::any Operate(const std::any& _lValue, const std::any& _rValue)
+{
+	return FindKernel(Operator, ToValueType(_lValue), ToValueType(_rValue))(_lValue, _rValue);
+}
+
+// Keeps the kernel picked for the first operand types seen at one site,
+// a type miss drops the site back to the table lookup for good
+class OperatorCache
+{
+public:
+	std::any Operate(EOperator _eOperator, const std::any& _lValue, const std::any& _rValue);
+
+private:
+	OperatorKernel m_pKernel = nullptr;
+	const std::type_info* m_pLhsType = nullptr;
+	const std::type_info* m_pRhsType = nullptr;
+	bool m_bGeneric = false;
+};
@@ -0,0 +1,517 @@
+#include <string>
+#include <algorithm>
+#include "Optimizer.h"
+#include "Object.h"
+#include "Evaluator.h"
+
+namespace
+{
+    // Unroll limits, the trip count and the statements the unrolled loop may grow to
+    constexpr uint64 g_iUnrollTripLimit = 8;
+    constexpr uint64 g_iUnrollStatementLimit = 16;
+
+    bool CanUnroll(const std::shared_ptr<Statement>& _pStatement, const std::string& _strName);
+
+    // false when the expression assigns the loop variable or is a node the walker does not know
+    bool CanUnroll(const std::shared_ptr<Expression>& _pExpression, const std::string& _strName)
+    {
+        if (_pExpression == nullptr || Optimizer::IsLiteral(_pExpression) ||
+            std::dynamic_pointer_cast<GetVariable>(_pExpression)) {
+            return true;
+        }
+        if (auto pSet = std::dynamic_pointer_cast<SetVariable>(_pExpression)) {
+            return pSet->m_strName != _strName && CanUnroll(pSet->m_pValue, _strName);
+        }
+        if (auto pOr = std::dynamic_pointer_cast<Or>(_pExpression)) {
+            return CanUnroll(pOr->m_pLhs, _strName) && CanUnroll(pOr->m_pRhs, _strName);
+        }
+        if (auto pAnd = std::dynamic_pointer_cast<And>(_pExpression)) {
+            return CanUnroll(pAnd->m_pLhs, _strName) && CanUnroll(pAnd->m_pRhs, _strName);
+        }
+        if (auto pRelational = std::dynamic_pointer_cast<Relational>(_pExpression)) {
+            return CanUnroll(pRelational->m_pLhs, _strName) && CanUnroll(pRelational->m_pRhs, _strName);
+        }
+        if (auto pArithmetic = std::dynamic_pointer_cast<Arithmetic>(_pExpression)) {
+            return CanUnroll(pArithmetic->m_pLhs, _strName) && CanUnroll(pArithmetic->m_pRhs, _strName);
+        }
+        if (auto pUnary = std::dynamic_pointer_cast<Unary>(_pExpression)) {
+            return CanUnroll(pUnary->m_pSub, _strName);
+        }
+        if (auto pCall = std::dynamic_pointer_cast<Call>(_pExpression)) {
+            return CanUnroll(pCall->m_pSub, _strName) && std::ranges::all_of(pCall->m_vecArgument,
+                [&](auto& _pArgument) { return CanUnroll(_pArgument, _strName); });
+        }
+        if (auto pGet = std::dynamic_pointer_cast<GetElement>(_pExpression)) {
+            return CanUnroll(pGet->m_pSub, _strName) && CanUnroll(pGet->m_pIndex, _strName);
+        }
+        if (auto pSet = std::dynamic_pointer_cast<SetElement>(_pExpression)) {
+            return CanUnroll(pSet->m_pSub, _strName) && CanUnroll(pSet->m_pIndex, _strName) && CanUnroll(pSet->m_pValue, _strName);
+        }
+        if (auto pArray = std::dynamic_pointer_cast<ArrayLiteral>(_pExpression)) {
+            return std::ranges::all_of(pArray->m_vecValue, [&](auto& _pValue) { return CanUnroll(_pValue, _strName); });
+        }
+        if (auto pMap = std::dynamic_pointer_cast<MapLiteral>(_pExpression)) {
+            return std::ranges::all_of(pMap->m_mapValue, [&](auto& _pair) { return CanUnroll(_pair.second, _strName); });
+        }
+        return false;
+    }
+
+    // false for Break/Continue, nested loops, redeclaring the loop variable and anything unknown
+    bool CanUnroll(const std::shared_ptr<Statement>& _pStatement, const std::string& _strName)
+    {
+        if (auto pVariable = std::dynamic_pointer_cast<Variable>(_pStatement)) {
+            return pVariable->m_strName != _strName && CanUnroll(pVariable->m_pExpression, _strName);
+        }
+        if (auto pExpression = std::dynamic_pointer_cast<ExpressionStatement>(_pStatement)) {
+            return CanUnroll(pExpression->m_pExpression, _strName);
+        }
+        if (auto pReturn = std::dynamic_pointer_cast<Return>(_pStatement)) {
+            return CanUnroll(pReturn->m_pExpression, _strName);
+        }
+        if (auto pPrint = std::dynamic_pointer_cast<Print>(_pStatement)) {
+            return std::ranges::all_of(pPrint->m_vecArgument, [&](auto& _pArgument) { return CanUnroll(_pArgument, _strName); });
+        }
+        if (auto pIf = std::dynamic_pointer_cast<If>(_pStatement)) {
+            auto canUnrollBlock = [&](auto& _vecBlock) {
+                return std::ranges::all_of(_vecBlock, [&](auto& _pNode) { return CanUnroll(_pNode, _strName); });
+            };
+            return std::ranges::all_of(pIf->m_vecCondition, [&](auto& _pCondition) { return CanUnroll(_pCondition, _strName); }) &&
+                std::ranges::all_of(pIf->m_vecBlocks, canUnrollBlock) && canUnrollBlock(pIf->m_vecElseBlock);
+        }
+        return false;
+    }
+
+    std::shared_ptr<NumberLiteral> ToNumberLiteral(const std::shared_ptr<Expression>& _pExpression)
+    {
+        return std::dynamic_pointer_cast<NumberLiteral>(_pExpression);
+    }
+
+    bool IsGetVariable(const std::shared_ptr<Expression>& _pExpression, const std::string& _strName)
+    {
+        auto pGet = std::dynamic_pointer_cast<GetVariable>(_pExpression);
+        return pGet && pGet->m_strName == _strName;
+    }
+}
+
+void Optimizer::Optimize(std::shared_ptr<Program> _pProgram)
+{
+    for (auto& pFunction : _pProgram->m_vecFunction) {
+        pFunction->Optimize();
+    }
+    for (auto& pClass : _pProgram->m_vecClass) {
+        pClass->Optimize();
+    }
+}
+
+void Optimizer::OptimizeBlock(std::vector<std::shared_ptr<Statement>>& _vecBlock)
+{
+    for (uint64 i = 0; i < _vecBlock.size(); ++i) {
+        _vecBlock[i]->Optimize();
+        if (auto pFor = std::dynamic_pointer_cast<For>(_vecBlock[i])) {
+            if (auto pUnrolled = Unroll(pFor)) {
+                _vecBlock[i] = pUnrolled;
+            }
+        }
+        if (std::dynamic_pointer_cast<Return>(_vecBlock[i]) ||
+            std::dynamic_pointer_cast<Break>(_vecBlock[i]) ||
+            std::dynamic_pointer_cast<Continue>(_vecBlock[i])) {
+            _vecBlock.resize(i + 1);
+            break;
+        }
+    }
+    std::erase_if(_vecBlock, [](std::shared_ptr<Statement>& _pStatement) {
+        auto pIf = std::dynamic_pointer_cast<If>(_pStatement);
+        return pIf && pIf->m_vecCondition.empty() && pIf->m_vecElseBlock.empty();
+    });
+}
+
+std::shared_ptr<Statement> Optimizer::Unroll(std::shared_ptr<For> _pFor)
+{
+    // for i = c0, i < n (or i <= n), i = i + step with literal c0, n and step
+    const std::string& strName = _pFor->m_pVariable->m_strName;
+    auto pStart = ToNumberLiteral(_pFor->m_pVariable->m_pExpression);
+    auto pCondition = std::dynamic_pointer_cast<Relational>(_pFor->m_pCondition);
+    auto pIncrement = std::dynamic_pointer_cast<SetVariable>(_pFor->m_pExpression);
+    if (pStart == nullptr || pCondition == nullptr || pIncrement == nullptr ||
+        (pCondition->m_eKind != EKind::LessThan && pCondition->m_eKind != EKind::LessOrEqual) ||
+        IsGetVariable(pCondition->m_pLhs, strName) == false || pIncrement->m_strName != strName) {
+        return nullptr;
+    }
+    auto pEnd = ToNumberLiteral(pCondition->m_pRhs);
+    auto pStep = std::dynamic_pointer_cast<Arithmetic>(pIncrement->m_pValue);
+    if (pEnd == nullptr || pStep == nullptr || pStep->m_eKind != EKind::Add || IsGetVariable(pStep->m_pLhs, strName) == false) {
+        return nullptr;
+    }
+    auto pStepValue = ToNumberLiteral(pStep->m_pRhs);
+    if (pStepValue == nullptr) {
+        return nullptr;
+    }
+
+    uint64 start = pStart->m_uValue;
+    uint64 end = pEnd->m_uValue;
+    uint64 step = pStepValue->m_uValue;
+    if (step == 0 || end > UINT64_MAX - step) {
+        return nullptr;
+    }
+    uint64 tripCount = 0;
+    if (pCondition->m_eKind == EKind::LessThan) {
+        tripCount = start < end ? (end - start + step - 1) / step : 0;
+    }
+    else {
+        tripCount = start <= end ? (end - start) / step + 1 : 0;
+    }
+    if (tripCount > g_iUnrollTripLimit || tripCount * _pFor->m_vecBlock.size() > g_iUnrollStatementLimit) {
+        return nullptr;
+    }
+    for (auto& pNode : _pFor->m_vecBlock) {
+        if (CanUnroll(pNode, strName) == false) {
+            return nullptr;
+        }
+    }
+
+    // The loop variable stays scoped to the outer block, each copy of the body gets its own scope
+    // so the variables it declares do not collide. The body nodes are shared between the copies,
+    // nothing after the Optimizer mutates the tree
+    auto pResult = std::make_shared<If>();
+    if (tripCount == 0) {
+        return pResult;
+    }
+    pResult->m_vecElseBlock.push_back(_pFor->m_pVariable);
+    auto pIncrementStatement = std::make_shared<ExpressionStatement>();
+    pIncrementStatement->m_pExpression = _pFor->m_pExpression;
+    for (uint64 i = 0; i < tripCount; ++i) {
+        if (i != 0) {
+            pResult->m_vecElseBlock.push_back(pIncrementStatement);
+        }
+        auto pBody = std::make_shared<If>();
+        pBody->m_vecElseBlock = _pFor->m_vecBlock;
+        pResult->m_vecElseBlock.push_back(pBody);
+    }
+    return pResult;
+}
+
+void Optimizer::Fold(std::shared_ptr<Expression>& _pExpression)
+{
+    if (_pExpression == nullptr) {
+        return;
+    }
+    if (auto pResult = _pExpression->Optimize()) {
+        _pExpression = pResult;
+    }
+}
+
+bool Optimizer::IsLiteral(const std::shared_ptr<Expression>& _pExpression)
+{
+    return std::dynamic_pointer_cast<NullLiteral>(_pExpression) ||
+        std::dynamic_pointer_cast<BooleanLiteral>(_pExpression) ||
+        std::dynamic_pointer_cast<NumberLiteral>(_pExpression) ||
+        std::dynamic_pointer_cast<FloatLiteral>(_pExpression) ||
+        std::dynamic_pointer_cast<StringLiteral>(_pExpression);
+}
+
+std::shared_ptr<Expression> Optimizer::MakeLiteral(const std::any& _anyValue)
+{
+    if (Object::IsNull(_anyValue)) {
+        return std::make_shared<NullLiteral>();
+    }
+    if (Object::IsBoolean(_anyValue)) {
+        auto pResult = std::make_shared<BooleanLiteral>();
+        pResult->m_bValue = Object::ToBoolean(_anyValue);
+        return pResult;
+    }
+    if (Object::IsNumber(_anyValue)) {
+        auto pResult = std::make_shared<NumberLiteral>();
+        pResult->m_uValue = Object::ToNumber(_anyValue);
+        return pResult;
+    }
+    if (Object::IsFloat(_anyValue)) {
+        auto pResult = std::make_shared<FloatLiteral>();
+        pResult->m_dValue = Object::ToFloat(_anyValue);
+        return pResult;
+    }
+    if (Object::IsString(_anyValue)) {
+        auto pResult = std::make_shared<StringLiteral>();
+        pResult->m_strValue = Object::ToString(_anyValue);
+        return pResult;
+    }
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Function
+void Function::Optimize()
+{
+    OptimizerMgr.OptimizeBlock(m_vecBlock);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - For
+void For::Optimize()
+{
+    m_pVariable->Optimize();
+    OptimizerMgr.Fold(m_pCondition);
+    OptimizerMgr.Fold(m_pExpression);
+    OptimizerMgr.OptimizeBlock(m_vecBlock);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - If
+void If::Optimize()
+{
+    for (uint64 i = 0; i < m_vecCondition.size(); ) {
+        OptimizerMgr.Fold(m_vecCondition[i]);
+        OptimizerMgr.OptimizeBlock(m_vecBlocks[i]);
+        if (Optimizer::IsLiteral(m_vecCondition[i]) == false) {
+            ++i;
+            continue;
+        }
+        if (Object::IsTrue(m_vecCondition[i]->Interpret())) {
+            // Always taken, it becomes the else block and the branches after it are unreachable
+            m_vecElseBlock = std::move(m_vecBlocks[i]);
+            m_vecCondition.erase(m_vecCondition.begin() + i, m_vecCondition.end());
+            m_vecBlocks.erase(m_vecBlocks.begin() + i, m_vecBlocks.end());
+            return;
+        }
+        m_vecCondition.erase(m_vecCondition.begin() + i);
+        m_vecBlocks.erase(m_vecBlocks.begin() + i);
+    }
+    OptimizerMgr.OptimizeBlock(m_vecElseBlock);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Variable
+void Variable::Optimize()
+{
+    OptimizerMgr.Fold(m_pExpression);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Print
+void Print::Optimize()
+{
+    for (auto& pArgument : m_vecArgument) {
+        OptimizerMgr.Fold(pArgument);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Return
+void Return::Optimize()
+{
+    OptimizerMgr.Fold(m_pExpression);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Break
+void Break::Optimize()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Continue
+void Continue::Optimize()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - ExpressionStatement
+void ExpressionStatement::Optimize()
+{
+    OptimizerMgr.Fold(m_pExpression);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Or
+std::shared_ptr<Expression> Or::Optimize()
+{
+    OptimizerMgr.Fold(m_pLhs);
+    OptimizerMgr.Fold(m_pRhs);
+    if (Optimizer::IsLiteral(m_pLhs) == false) {
+        return nullptr;
+    }
+    if (Object::IsTrue(m_pLhs->Interpret())) {
+        return Optimizer::MakeLiteral(true);
+    }
+    return m_pRhs;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - And
+std::shared_ptr<Expression> And::Optimize()
+{
+    OptimizerMgr.Fold(m_pLhs);
+    OptimizerMgr.Fold(m_pRhs);
+    if (Optimizer::IsLiteral(m_pLhs) == false) {
+        return nullptr;
+    }
+    if (Object::IsFalse(m_pLhs->Interpret())) {
+        return Optimizer::MakeLiteral(false);
+    }
+    return m_pRhs;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Relational
+std::shared_ptr<Expression> Relational::Optimize()
+{
+    OptimizerMgr.Fold(m_pLhs);
+    OptimizerMgr.Fold(m_pRhs);
+    if (Optimizer::IsLiteral(m_pLhs) == false || Optimizer::IsLiteral(m_pRhs) == false) {
+        return nullptr;
+    }
+    return Optimizer::MakeLiteral(Operate(ToOperator(m_eKind), m_pLhs->Interpret(), m_pRhs->Interpret()));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Arithmetic
+std::shared_ptr<Expression> Arithmetic::Optimize()
+{
+    OptimizerMgr.Fold(m_pLhs);
+    OptimizerMgr.Fold(m_pRhs);
+    if (Optimizer::IsLiteral(m_pLhs) == false || Optimizer::IsLiteral(m_pRhs) == false) {
+        return nullptr;
+    }
+    return Optimizer::MakeLiteral(Operate(ToOperator(m_eKind), m_pLhs->Interpret(), m_pRhs->Interpret()));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Unary
+std::shared_ptr<Expression> Unary::Optimize()
+{
+    OptimizerMgr.Fold(m_pSub);
+    if (Optimizer::IsLiteral(m_pSub) == false) {
+        return nullptr;
+    }
+    return Optimizer::MakeLiteral(Interpret());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Call
+std::shared_ptr<Expression> Call::Optimize()
+{
+    OptimizerMgr.Fold(m_pSub);
+    for (auto& pArgument : m_vecArgument) {
+        OptimizerMgr.Fold(pArgument);
+    }
+    if (auto pGetVariable = std::dynamic_pointer_cast<GetVariable>(m_pSub)) {
+        return EvaluatorMgr.Evaluate(pGetVariable->m_strName, m_vecArgument);
+    }
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - GetElement
+std::shared_ptr<Expression> GetElement::Optimize()
+{
+    OptimizerMgr.Fold(m_pSub);
+    OptimizerMgr.Fold(m_pIndex);
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SetElement
+std::shared_ptr<Expression> SetElement::Optimize()
+{
+    OptimizerMgr.Fold(m_pSub);
+    OptimizerMgr.Fold(m_pIndex);
+    OptimizerMgr.Fold(m_pValue);
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - GetVariable
+std::shared_ptr<Expression> GetVariable::Optimize()
+{
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SetVariable
+std::shared_ptr<Expression> SetVariable::Optimize()
+{
+    OptimizerMgr.Fold(m_pValue);
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - NullLiteral
+std::shared_ptr<Expression> NullLiteral::Optimize()
+{
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - BooleanLiteral
+std::shared_ptr<Expression> BooleanLiteral::Optimize()
+{
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - NumberLiteral
+std::shared_ptr<Expression> NumberLiteral::Optimize()
+{
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - FloatLiteral
+std::shared_ptr<Expression> FloatLiteral::Optimize()
+{
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - StringLiteral
+std::shared_ptr<Expression> StringLiteral::Optimize()
+{
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - ArrayLiteral
+std::shared_ptr<Expression> ArrayLiteral::Optimize()
+{
+    for (auto& pValue : m_vecValue) {
+        OptimizerMgr.Fold(pValue);
+    }
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - MapLiteral
+std::shared_ptr<Expression> MapLiteral::Optimize()
+{
+    for (auto& [key, pValue] : m_mapValue) {
+        OptimizerMgr.Fold(pValue);
+    }
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Class
+void Class::Optimize()
+{
+    for (auto& member : m_vecVariable) {
+        member.m_pVariable->Optimize();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SetClassAccess
+std::shared_ptr<Expression> SetClassAccess::Optimize()
+{
+    OptimizerMgr.Fold(m_pSub);
+    OptimizerMgr.Fold(m_pMember);
+    OptimizerMgr.Fold(m_pValue);
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - GetClassAccess
+std::shared_ptr<Expression> GetClassAccess::Optimize()
+{
+    OptimizerMgr.Fold(m_pSub);
+    OptimizerMgr.Fold(m_pMember);
+    return nullptr;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <any>
+#include <vector>
+#include <memory>
+#include "TypeDefine.h"
+#include "Node.h"
+
+// Syntax tree pass run before Interpret and Generate,
+// folds literal only expressions, removes code that can never run
+// and unrolls short loops with literal bounds
+class Optimizer
+{
+private:
+	Optimizer() { }
+	~Optimizer() { }
+public:
+	static Optimizer& GetInstance()
+	{
+		static thread_local Optimizer instance;
+		return instance;
+	}
+#define OptimizerMgr		Optimizer::GetInstance()
+
+public:
+	void Optimize(std::shared_ptr<Program> _pProgram);
+	void OptimizeBlock(std::vector<std::shared_ptr<Statement>>& _vecBlock);
+	void Fold(std::shared_ptr<Expression>& _pExpression);
+	// Straight line replacement of a loop with literal bounds and a small trip count, nullptr when it does not apply
+	std::shared_ptr<Statement> Unroll(std::shared_ptr<For> _pFor);
+
+public:
+	static bool IsLiteral(const std::shared_ptr<Expression>& _pExpression);
+	static std::shared_ptr<Expression> MakeLiteral(const std::any& _anyValue);
+};
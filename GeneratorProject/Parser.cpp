@@ -2,17 +2,51 @@
 
 namespace
 {
-    static std::vector<CodeToken>::iterator g_current;
+    class VectorTokenStream : public TokenStream
+    {
+    public:
+        VectorTokenStream(std::vector<CodeToken>& _vecToken) : m_vecToken(_vecToken) { }
+
+        const CodeToken& Next() override
+        {
+            // EndOfToken is sticky
+            if (m_iIndex + 1 < m_vecToken.size()) {
+                return m_vecToken[m_iIndex++];
+            }
+            return m_vecToken.back();
+        }
+
+    private:
+        std::vector<CodeToken>& m_vecToken;
+        uint64 m_iIndex = 0;
+    };
+
+    // Parser of each thread reads its own stream
+    static thread_local TokenStream* g_pStream;
+    static thread_local const CodeToken* g_current;
 }
 
 std::shared_ptr<Program> Parser::Parse(std::vector<CodeToken> _tokens)
+{
+    VectorTokenStream stream(_tokens);
+    return Parse(stream);
+}
+
+std::shared_ptr<Program> Parser::Parse(TokenStream& _stream, std::function<void(std::shared_ptr<Function>)> _fnOnFunction)
 {
     auto pResult = std::make_shared<Program>();
-    g_current = _tokens.begin();
+    g_pStream = &_stream;
+    g_current = &g_pStream->Next();
     while (g_current->m_eKind != EKind::EndOfToken) {
         switch (g_current->m_eKind) {
+        case EKind::Inline:
+        case EKind::NoInline:
+        case EKind::Memo:
         case EKind::Function: {
             pResult->m_vecFunction.push_back(ParseFunction());
+            if (_fnOnFunction) {
+                _fnOnFunction(pResult->m_vecFunction.back());
+            }
             break;
         case EKind::Class:
             pResult->m_vecClass.push_back(ParseClass());
@@ -29,6 +63,20 @@ std::shared_ptr<Program> Parser::Parse(std::vector<CodeToken> _tokens)
 std::shared_ptr<Function> Parser::ParseFunction()
 {
     auto pResult = std::make_shared<Function>();
+    while (true) {
+        if (SkipCurrentIf(EKind::Inline)) {
+            pResult->m_eInline = EInlineHint::Always;
+        }
+        else if (SkipCurrentIf(EKind::NoInline)) {
+            pResult->m_eInline = EInlineHint::Never;
+        }
+        else if (SkipCurrentIf(EKind::Memo)) {
+            pResult->m_bMemo = true;
+        }
+        else {
+            break;
+        }
+    }
     SkipCurrent(EKind::Function);
     pResult->m_strName = g_current->m_strName;
     SkipCurrent(EKind::Identifier);
@@ -361,7 +409,7 @@ std::shared_ptr<Expression> Parser::ParseBooleanLiteral()
 std::shared_ptr<Expression> Parser::ParseNumberLiteral()
 {
     auto pResult = std::make_shared<NumberLiteral>();
-    pResult->m_uValue = std::stoll(g_current->m_strName);
+    pResult->m_uValue = g_current->m_uValue;
     SkipCurrent(EKind::NumberLiteral);
     return pResult;
 }
@@ -369,7 +417,7 @@ std::shared_ptr<Expression> Parser::ParseNumberLiteral()
 std::shared_ptr<Expression> Parser::ParseFloatLiteral()
 {
     auto pResult = std::make_shared<FloatLiteral>();
-    pResult->m_dValue = std::stod(g_current->m_strName);
+    pResult->m_dValue = g_current->m_dValue;
     SkipCurrent(EKind::FloatLiteral);
     return pResult;
 }
@@ -377,7 +425,7 @@ std::shared_ptr<Expression> Parser::ParseFloatLiteral()
 std::shared_ptr<Expression> Parser::ParseStringLiteral()
 {
     auto pResult = std::make_shared<StringLiteral>();
-    pResult->m_strValue = g_current->m_strName;
+    pResult->m_strValue = ToLiteral(g_current->m_uValue);
     SkipCurrent(EKind::StringLiteral);
     return pResult;
 }
@@ -402,7 +450,7 @@ std::shared_ptr<Expression> Parser::ParseMapLiteral()
     SkipCurrent(EKind::LeftBrace);
     if (g_current->m_eKind != EKind::RightBrace) {
         do {
-            auto name = g_current->m_strName;
+            auto name = ToLiteral(g_current->m_uValue);
             SkipCurrent(EKind::StringLiteral);
             SkipCurrent(EKind::Colon);
             auto value = ParseExpression();
@@ -502,7 +550,7 @@ std::shared_ptr<GetClassAccess> Parser::ParseClassAccess(std::shared_ptr<Express
 
 void Parser::SkipCurrent()
 {
-    g_current++;
+    g_current = &g_pStream->Next();
 }
 
 void Parser::SkipCurrent(EKind _eKind)
@@ -510,7 +558,7 @@ void Parser::SkipCurrent(EKind _eKind)
     if (g_current->m_eKind != _eKind) {
         throw;
     }
-    g_current++;
+    g_current = &g_pStream->Next();
 }
 
 bool Parser::SkipCurrentIf(EKind _eKind)
@@ -518,6 +566,6 @@ bool Parser::SkipCurrentIf(EKind _eKind)
     if (g_current->m_eKind != _eKind) {
         return false;
     }
-    g_current++;
+    g_current = &g_pStream->Next();
     return true;
 }
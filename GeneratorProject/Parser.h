@@ -6,6 +6,14 @@
 #include "Token.h"
 #include "Node.h"
 
+// Where the parser pulls its tokens from, the pipeline feeds one from the scanner thread
+class TokenStream
+{
+public:
+	virtual ~TokenStream() { }
+	virtual const CodeToken& Next() = 0;
+};
+
 class Parser
 {
 private:
@@ -13,11 +21,12 @@ private:
 public:
 	__forceinline static Parser& GetInstance()
 	{
-		static Parser instance;
+		static thread_local Parser instance;
 		return instance;
 	}
 public:
 	std::shared_ptr<Program> Parse(std::vector<CodeToken> _vecCodeToken);
+	std::shared_ptr<Program> Parse(TokenStream& _stream, std::function<void(std::shared_ptr<Function>)> _fnOnFunction = nullptr);
 	
 	std::shared_ptr<Function> ParseFunction();
 	std::vector<std::shared_ptr<Statement>> ParseBlock();
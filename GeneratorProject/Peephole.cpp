@@ -0,0 +1,282 @@
+#include <bit>
+#include "Peephole.h"
+#include "Object.h"
+
+namespace
+{
+    bool IsJump(Instruction _instruction)
+    {
+        return _instruction == Instruction::Jump ||
+            _instruction == Instruction::ConditionJump ||
+            _instruction == Instruction::LoopJump ||
+            _instruction == Instruction::LogicalOr ||
+            _instruction == Instruction::LogicalAnd;
+    }
+
+    bool IsPush(Instruction _instruction)
+    {
+        return _instruction == Instruction::PushNull ||
+            _instruction == Instruction::PushBoolean ||
+            _instruction == Instruction::PushNumber ||
+            _instruction == Instruction::PushString;
+    }
+
+    uint64 ToAddress(const Code& _code)
+    {
+        return std::any_cast<uint64>(_code.m_anyOperand);
+    }
+
+    struct PeepholeContext
+    {
+    public:
+        bool IsLive(uint64 _index) const
+        {
+            return _index < m_vecCode.size() && m_vecRemoved[_index] == false;
+        }
+
+        bool IsTarget(uint64 _index) const
+        {
+            return _index < m_vecTarget.size() && m_vecTarget[_index];
+        }
+
+        uint64 Next(uint64 _index) const
+        {
+            do {
+                ++_index;
+            } while (_index < m_vecCode.size() && m_vecRemoved[_index]);
+            return _index;
+        }
+
+        bool IsAt(uint64 _index, Instruction _instruction) const
+        {
+            return IsLive(_index) && m_vecCode[_index].m_instruction == _instruction;
+        }
+
+        void Remove(uint64 _index)
+        {
+            m_vecRemoved[_index] = true;
+        }
+
+    public:
+        std::vector<Code>& m_vecCode;
+        std::vector<bool> m_vecRemoved;
+        std::vector<bool> m_vecTarget;
+    };
+
+    // SetLocal n, PopOperand, GetLocal n -> SetLocal n
+    bool ApplyStoreReload(PeepholeContext& _context, uint64 _index)
+    {
+        auto& vecCode = _context.m_vecCode;
+        uint64 pop = _context.Next(_index);
+        uint64 load = _context.Next(pop);
+        if (vecCode[_index].m_instruction != Instruction::SetLocal ||
+            _context.IsAt(pop, Instruction::PopOperand) == false || _context.IsTarget(pop) ||
+            _context.IsAt(load, Instruction::GetLocal) == false || _context.IsTarget(load) ||
+            ToAddress(vecCode[load]) != ToAddress(vecCode[_index])) {
+            return false;
+        }
+        _context.Remove(pop);
+        _context.Remove(load);
+        return true;
+    }
+
+    // Push or GetLocal immediately popped -> nothing
+    bool ApplyPushPop(PeepholeContext& _context, uint64 _index)
+    {
+        uint64 pop = _context.Next(_index);
+        Instruction instruction = _context.m_vecCode[_index].m_instruction;
+        if ((IsPush(instruction) == false && instruction != Instruction::GetLocal) ||
+            _context.IsAt(pop, Instruction::PopOperand) == false || _context.IsTarget(pop)) {
+            return false;
+        }
+        _context.Remove(_index);
+        _context.Remove(pop);
+        return true;
+    }
+
+    // Literal followed by ConditionJump -> nothing when true, Jump otherwise, LoopJump the other way around
+    bool ApplyConstantCondition(PeepholeContext& _context, uint64 _index)
+    {
+        auto& vecCode = _context.m_vecCode;
+        uint64 jump = _context.Next(_index);
+        if (IsPush(vecCode[_index].m_instruction) == false || _context.IsTarget(jump) ||
+            (_context.IsAt(jump, Instruction::ConditionJump) == false && _context.IsAt(jump, Instruction::LoopJump) == false)) {
+            return false;
+        }
+        bool bTrue = vecCode[_index].m_instruction == Instruction::PushBoolean && Object::IsTrue(vecCode[_index].m_anyOperand);
+        if (vecCode[jump].m_instruction == Instruction::LoopJump) {
+            bTrue = bTrue == false;
+        }
+        _context.Remove(_index);
+        if (bTrue) {
+            _context.Remove(jump);
+        }
+        else {
+            vecCode[jump].m_instruction = Instruction::Jump;
+        }
+        return true;
+    }
+
+    // Jump to a Jump -> jump straight to the final target
+    bool ApplyJumpThreading(PeepholeContext& _context, uint64 _index)
+    {
+        auto& vecCode = _context.m_vecCode;
+        if (IsJump(vecCode[_index].m_instruction) == false) {
+            return false;
+        }
+        uint64 target = ToAddress(vecCode[_index]);
+        for (uint64 i = 0; i < 16 && _context.IsAt(target, Instruction::Jump) && ToAddress(vecCode[target]) != target; ++i) {
+            target = ToAddress(vecCode[target]);
+        }
+        if (target == ToAddress(vecCode[_index])) {
+            return false;
+        }
+        vecCode[_index].m_anyOperand = target;
+        return true;
+    }
+
+    // Jump to the next instruction -> nothing, ConditionJump/LoopJump to the next instruction -> PopOperand
+    bool ApplyJumpToNext(PeepholeContext& _context, uint64 _index)
+    {
+        auto& vecCode = _context.m_vecCode;
+        Instruction instruction = vecCode[_index].m_instruction;
+        if ((instruction != Instruction::Jump && instruction != Instruction::ConditionJump && instruction != Instruction::LoopJump) ||
+            ToAddress(vecCode[_index]) != _context.Next(_index)) {
+            return false;
+        }
+        if (instruction == Instruction::Jump) {
+            _context.Remove(_index);
+        }
+        else {
+            vecCode[_index] = { Instruction::PopOperand };
+        }
+        return true;
+    }
+
+    // Nothing after Jump/Return/Exit runs until the next jump target
+    bool ApplyUnreachable(PeepholeContext& _context, uint64 _index)
+    {
+        Instruction instruction = _context.m_vecCode[_index].m_instruction;
+        if (instruction != Instruction::Jump && instruction != Instruction::Return && instruction != Instruction::Exit) {
+            return false;
+        }
+        bool bResult = false;
+        for (uint64 i = _context.Next(_index); _context.IsLive(i) && _context.IsTarget(i) == false; i = _context.Next(i)) {
+            _context.Remove(i);
+            bResult = true;
+        }
+        return bResult;
+    }
+
+    // PushNumber 2^k, Multiply/MultiplyU64 -> PushNumber k, ShiftLeft
+    bool ApplyMultiplyPowerOfTwo(PeepholeContext& _context, uint64 _index)
+    {
+        auto& vecCode = _context.m_vecCode;
+        uint64 multiply = _context.Next(_index);
+        if (vecCode[_index].m_instruction != Instruction::PushNumber || vecCode[_index].m_anyOperand.type() != typeid(uint64) ||
+            (_context.IsAt(multiply, Instruction::Multiply) == false && _context.IsAt(multiply, Instruction::MultiplyU64) == false) ||
+            _context.IsTarget(multiply)) {
+            return false;
+        }
+        uint64 value = std::any_cast<uint64>(vecCode[_index].m_anyOperand);
+        if (value < 2 || std::has_single_bit(value) == false) {
+            return false;
+        }
+        vecCode[_index].m_anyOperand = static_cast<uint64>(std::countr_zero(value));
+        vecCode[multiply].m_instruction = Instruction::ShiftLeft;
+        return true;
+    }
+
+    struct PeepholePattern
+    {
+        const char* m_strName;
+        bool (*m_fnApply)(PeepholeContext&, uint64);
+    };
+
+    static const std::vector<PeepholePattern> g_vecPatternTable =
+    {
+        { "StoreReload",        ApplyStoreReload },
+        { "PushPop",            ApplyPushPop },
+        { "ConstantCondition",  ApplyConstantCondition },
+        { "JumpThreading",      ApplyJumpThreading },
+        { "JumpToNext",         ApplyJumpToNext },
+        { "Unreachable",        ApplyUnreachable },
+        { "MultiplyPowerOfTwo", ApplyMultiplyPowerOfTwo },
+    };
+}
+
+void Peephole::Optimize(std::vector<Code>& _vecCode, std::map<std::string, uint64>& _mapFunctionTable)
+{
+    m_mapRemovedCount.clear();
+    for (auto& [name, address] : _mapFunctionTable) {
+        m_mapRemovedCount[name] = 0;
+    }
+
+    bool bChanged = true;
+    while (bChanged) {
+        bChanged = false;
+        PeepholeContext context = { _vecCode, std::vector<bool>(_vecCode.size()), std::vector<bool>(_vecCode.size() + 1) };
+        context.m_vecTarget[0] = true;
+        for (auto& [name, address] : _mapFunctionTable) {
+            context.m_vecTarget[address] = true;
+        }
+        for (auto& code : _vecCode) {
+            if (IsJump(code.m_instruction)) {
+                context.m_vecTarget[ToAddress(code)] = true;
+            }
+        }
+
+        for (uint64 i = 0; i < _vecCode.size(); i = context.Next(i)) {
+            for (auto& pattern : g_vecPatternTable) {
+                if (context.IsLive(i) && pattern.m_fnApply(context, i)) {
+                    bChanged = true;
+                }
+            }
+        }
+
+        // Removed instructions map to the next live one so jumps into them still land correctly
+        std::vector<uint64> vecNewIndex(_vecCode.size() + 1);
+        std::vector<Code> vecResult;
+        vecResult.reserve(_vecCode.size());
+        for (uint64 i = 0; i < _vecCode.size(); ++i) {
+            vecNewIndex[i] = vecResult.size();
+            if (context.m_vecRemoved[i] == false) {
+                vecResult.push_back(std::move(_vecCode[i]));
+            }
+        }
+        vecNewIndex[_vecCode.size()] = vecResult.size();
+
+        for (auto& code : vecResult) {
+            if (IsJump(code.m_instruction)) {
+                code.m_anyOperand = vecNewIndex[ToAddress(code)];
+            }
+        }
+
+        std::map<uint64, std::string> mapEntryTable;
+        for (auto& [name, address] : _mapFunctionTable) {
+            mapEntryTable[address] = name;
+        }
+        for (uint64 i = 0; i < _vecCode.size(); ++i) {
+            if (context.m_vecRemoved[i] == false) {
+                continue;
+            }
+            auto findIt = mapEntryTable.upper_bound(i);
+            if (findIt != mapEntryTable.begin()) {
+                m_mapRemovedCount[std::prev(findIt)->second] += 1;
+            }
+        }
+        for (auto& [name, address] : _mapFunctionTable) {
+            address = vecNewIndex[address];
+        }
+        _vecCode = std::move(vecResult);
+    }
+}
+
+std::string Peephole::PrintReport()
+{
+    std::string strResult;
+    for (auto& [name, count] : m_mapRemovedCount) {
+        strResult += name + " : " + std::to_string(count) + " removed\n";
+    }
+    return strResult;
+}
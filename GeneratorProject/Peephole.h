@@ -0,0 +1,31 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <string>
+#include "TypeDefine.h"
+#include "Code.h"
+
+// Rewrites short instruction sequences after Generate,
+// jump targets and the function table are remapped when instructions are removed
+class Peephole
+{
+private:
+	Peephole() { }
+	~Peephole() { }
+public:
+	static Peephole& GetInstance()
+	{
+		static thread_local Peephole instance;
+		return instance;
+	}
+#define PeepholeMgr		Peephole::GetInstance()
+
+public:
+	void Optimize(std::vector<Code>& _vecCode, std::map<std::string, uint64>& _mapFunctionTable);
+	std::string PrintReport();
+
+public:
+	// Function name -> instructions removed by the last Optimize
+	std::map<std::string, uint64> m_mapRemovedCount;
+};
@@ -0,0 +1,83 @@
+#include <thread>
+#include <algorithm>
+#include "Pipeline.h"
+#include "RingBuffer.h"
+#include "Scanner.h"
+#include "Parser.h"
+#include "CallGraph.h"
+#include "Builtin.h"
+
+namespace
+{
+    constexpr uint64 TokenQueueSize = 1024;
+    constexpr uint64 FunctionQueueSize = 64;
+
+    using TokenQueue = RingBuffer<CodeToken, TokenQueueSize>;
+    using FunctionQueue = RingBuffer<std::shared_ptr<Function>, FunctionQueueSize>;
+
+    class QueueTokenStream : public TokenStream
+    {
+    public:
+        QueueTokenStream(TokenQueue& _queue) : m_queue(_queue) { }
+
+        const CodeToken& Next() override
+        {
+            // The scanner stops after EndOfToken so it is sticky
+            if (m_current.m_eKind != EKind::EndOfToken) {
+                m_current = m_queue.Pop();
+            }
+            return m_current;
+        }
+
+    private:
+        TokenQueue& m_queue;
+        CodeToken m_current;
+    };
+}
+
+std::tuple<std::vector<Code>, std::map<std::string, std::size_t>> Pipeline::Compile(std::string _sourceCode)
+{
+    TokenQueue tokenQueue;
+    FunctionQueue functionQueue;
+    // Scanner and Parser of the worker threads are their own, the literals go to the pool of this thread
+    LiteralPool* pLiteralPool = CurrentLiteralPool();
+
+    std::thread scanThread([&tokenQueue, &_sourceCode, pLiteralPool]() {
+        ShareLiteralPool(pLiteralPool);
+        Scanner::GetInstance().Scan(_sourceCode, [&tokenQueue](CodeToken&& _token) {
+            tokenQueue.Push(std::move(_token));
+        });
+    });
+
+    std::thread parseThread([this, &tokenQueue, &functionQueue, pLiteralPool]() {
+        ShareLiteralPool(pLiteralPool);
+        QueueTokenStream stream(tokenQueue);
+        m_pProgram = Parser::GetInstance().Parse(stream, [&functionQueue](std::shared_ptr<Function> _pFunction) {
+            functionQueue.Push(_pFunction);
+        });
+        // nullptr closes the function queue
+        functionQueue.Push(nullptr);
+    });
+
+    GeneraterMgr.BeginGenerate();
+    while (auto pFunction = functionQueue.Pop()) {
+        GeneraterMgr.GenerateFunction(pFunction);
+    }
+
+    scanThread.join();
+    parseThread.join();
+    auto result = GeneraterMgr.EndGenerate();
+
+    // A function was generated before the ones after it were parsed, so an assignment to a function or builtin name
+    // there may have changed a call already inlined or evaluated : such a program is compiled again as a whole
+    CallGraphMgr.CollectAssigned(m_pProgram);
+    for (auto& strName : CallGraphMgr.m_setAssigned) {
+        bool bFunction = std::ranges::any_of(m_pProgram->m_vecFunction, 
+            [&strName](const std::shared_ptr<Function>& _pFunction) { return _pFunction->m_strName == strName; });
+        if (bFunction || BuiltinMgr.Find(strName) != SIZE_MAX) {
+            m_pProgram = Parser::GetInstance().Parse(Scanner::GetInstance().Scan(_sourceCode));
+            return GeneraterMgr.Generate(m_pProgram);
+        }
+    }
+    return result;
+}
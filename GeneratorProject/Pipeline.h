@@ -0,0 +1,32 @@
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include <string>
+#include <memory>
+#include "TypeDefine.h"
+#include "Node.h"
+
+// Scanner, Parser and Generater on their own threads,
+// tokens and finished functions are handed over through RingBuffer
+class Pipeline
+{
+private:
+	Pipeline() { }
+	~Pipeline() { }
+public:
+	static Pipeline& GetInstance()
+	{
+		static thread_local Pipeline instance;
+		return instance;
+	}
+#define PipelineMgr		Pipeline::GetInstance()
+
+public:
+	auto Compile(std::string _sourceCode) -> std::tuple<std::vector<Code>, std::map<std::string, std::size_t>>;
+
+public:
+	// Whole tree of the last Compile for views and the Interpreter
+	std::shared_ptr<Program> m_pProgram;
+};
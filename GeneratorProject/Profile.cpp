@@ -0,0 +1,135 @@
+#include <fstream>
+#include <sstream>
+#include "Profile.h"
+
+void Profile::Clear()
+{
+    m_mapSite.clear();
+    m_vecRunSite.clear();
+}
+
+bool Profile::Load(const std::string& _strPath)
+{
+    std::ifstream file(_strPath);
+    if (file.is_open() == false) {
+        return false;
+    }
+    Clear();
+    // site <function> <ordinal> <count> <true> <lhs> <rhs>
+    // target <function> <ordinal> <callee> <count>
+    std::string strLine;
+    while (std::getline(file, strLine)) {
+        std::istringstream stream(strLine);
+        std::string strKind;
+        SiteKey key;
+        stream >> strKind >> key.first >> key.second;
+        SiteProfile& site = m_mapSite[key];
+        if (strKind == "site") {
+            stream >> site.m_iCount >> site.m_iTrue >> site.m_lhs >> site.m_rhs;
+        }
+        else if (strKind == "target") {
+            std::string strCallee;
+            uint64 count = 0;
+            stream >> strCallee >> count;
+            site.m_mapTarget[strCallee] += count;
+        }
+    }
+    return true;
+}
+
+bool Profile::Save(const std::string& _strPath)
+{
+    std::ofstream file(_strPath);
+    if (file.is_open() == false) {
+        return false;
+    }
+    for (auto& [key, site] : m_mapSite) {
+        file << "site " << key.first << ' ' << key.second << ' ' << site.m_iCount << ' ' << site.m_iTrue << ' '
+            << site.m_lhs << ' ' << site.m_rhs << '\n';
+        for (auto& [strCallee, count] : site.m_mapTarget) {
+            file << "target " << key.first << ' ' << key.second << ' ' << strCallee << ' ' << count << '\n';
+        }
+    }
+    return true;
+}
+
+std::string Profile::PrintReport()
+{
+    std::string strResult;
+    for (auto& [key, site] : m_mapSite) {
+        if (key.second == 0 && site.m_iCount != 0) {
+            strResult += key.first + " : called " + std::to_string(site.m_iCount) + "\n";
+        }
+    }
+    return strResult;
+}
+
+void Profile::BeginCompile()
+{
+    m_mapNodeSite.clear();
+    m_vecCodeSite.assign(1, SiteKey());
+    m_vecRunSite.clear();
+}
+
+void Profile::NumberSites(std::shared_ptr<Function> _pFunction)
+{
+    const std::string& strName = _pFunction->m_strName;
+    uint64 ordinal = 0;
+    m_mapNodeSite.emplace(_pFunction.get(), SiteKey(strName, ordinal++));
+
+    // Pre-order, a node shared by several places keeps the number of the first
+    std::function<void(const std::shared_ptr<Statement>&)> visitStatement;
+    std::function<void(const std::shared_ptr<Expression>&)> visitExpression;
+    ChildVisitor visitor = { 
+        [&](const std::shared_ptr<Statement>& _pChild) { visitStatement(_pChild); },
+        [&](const std::shared_ptr<Expression>& _pChild) { visitExpression(_pChild); },
+    };
+    visitStatement = [&](const std::shared_ptr<Statement>& _pStatement) {
+        if (auto pIf = std::dynamic_pointer_cast<If>(_pStatement)) {
+            if (m_mapNodeSite.emplace(pIf.get(), SiteKey(strName, ordinal)).second) {
+                ordinal += pIf->m_vecCondition.size();
+            }
+        }
+        _pStatement->ForEachChild(visitor);
+    };
+    visitExpression = [&](const std::shared_ptr<Expression>& _pExpression) {
+        if (std::dynamic_pointer_cast<Arithmetic>(_pExpression) || std::dynamic_pointer_cast<Relational>(_pExpression) ||
+            std::dynamic_pointer_cast<Call>(_pExpression)) {
+            if (m_mapNodeSite.emplace(_pExpression.get(), SiteKey(strName, ordinal)).second) {
+                ordinal += 1;
+            }
+        }
+        _pExpression->ForEachChild(visitor);
+    };
+    for (auto& pNode : _pFunction->m_vecBlock) {
+        visitStatement(pNode);
+    }
+}
+
+uint32 Profile::ToCodeSite(const void* _pNode, uint64 _offset)
+{
+    auto findIt = m_mapNodeSite.find(_pNode);
+    if (findIt == m_mapNodeSite.end()) {
+        return 0;
+    }
+    m_vecCodeSite.emplace_back(findIt->second.first, findIt->second.second + _offset);
+    return static_cast<uint32>(m_vecCodeSite.size() - 1);
+}
+
+const SiteProfile* Profile::Find(const void* _pNode, uint64 _offset) const
+{
+    auto findIt = m_mapNodeSite.find(_pNode);
+    if (findIt == m_mapNodeSite.end()) {
+        return nullptr;
+    }
+    auto siteIt = m_mapSite.find(SiteKey(findIt->second.first, findIt->second.second + _offset));
+    return siteIt == m_mapSite.end() ? nullptr : &siteIt->second;
+}
+
+void Profile::BeginRun()
+{
+    m_vecRunSite.assign(m_vecCodeSite.size(), nullptr);
+    for (uint64 i = 1; i < m_vecCodeSite.size(); ++i) {
+        m_vecRunSite[i] = &m_mapSite[m_vecCodeSite[i]];
+    }
+}
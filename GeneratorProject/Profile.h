@@ -0,0 +1,74 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <memory>
+#include <string>
+#include "TypeDefine.h"
+#include "TypeInference.h"
+#include "Node.h"
+
+// Feedback the Machine gathers at one site over every profiled run
+struct SiteProfile
+{
+public:
+	// Times the site ran, for a function site the calls to it
+	uint64 m_iCount = 0;
+	// ConditionJump/LoopJump : times the condition held
+	uint64 m_iTrue = 0;
+	// Binary operators : types seen on each side
+	TypeSet m_lhs = TypeNone;
+	TypeSet m_rhs = TypeNone;
+	// Call : callee name -> times called
+	std::map<std::string, uint64> m_mapTarget;
+};
+
+// Profile guided compilation : Generate tags the code of every site with Code::m_iSite,
+// the Machine records feedback per site while m_bProfile is set and the next Generate reads it back.
+// Sites are keyed by function name and the order of the node in the optimized function, so a profile
+// survives recompiling the same script
+class Profile
+{
+private:
+	Profile() { }
+	~Profile() { }
+public:
+	static Profile& GetInstance()
+	{
+		static thread_local Profile instance;
+		return instance;
+	}
+#define ProfileMgr		Profile::GetInstance()
+
+public:
+	using SiteKey = std::pair<std::string, uint64>;
+
+	void Clear();
+	bool Load(const std::string& _strPath);
+	bool Save(const std::string& _strPath);
+	std::string PrintReport();
+
+	// Per compile : numbers the function itself, its If conditions, operators and calls
+	void BeginCompile();
+	void NumberSites(std::shared_ptr<Function> _pFunction);
+	// Tag for the code of the node, the n-th condition of an If passes n, 0 for nodes that are not sites
+	uint32 ToCodeSite(const void* _pNode, uint64 _offset = 0);
+	// Recorded feedback for the node, nullptr when no profiled run reached the code it was compiled to
+	const SiteProfile* Find(const void* _pNode, uint64 _offset = 0) const;
+
+	// Per run : the profile entry of each tag, created empty so sites that never run read as cold
+	void BeginRun();
+	SiteProfile& AtCodeSite(uint32 _iSite) { return *m_vecRunSite[_iSite]; }
+
+public:
+	// Call sites run at least this often get m_iHotInlineScale times the inline budget
+	uint64 m_iHotCallCount = 1000;
+	uint64 m_iHotInlineScale = 4;
+
+private:
+	std::map<SiteKey, SiteProfile> m_mapSite;
+	std::map<const void*, SiteKey> m_mapNodeSite;
+	// Tag -> site, tag 0 is no site
+	std::vector<SiteKey> m_vecCodeSite;
+	std::vector<SiteProfile*> m_vecRunSite;
+};
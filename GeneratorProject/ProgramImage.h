@@ -0,0 +1,28 @@
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include <memory>
+#include <string>
+#include "TypeDefine.h"
+#include "Code.h"
+
+// Finished object code of one Generate, never changed after it is made. Constants live in the operands of its code.
+// Runs share one image through the shared_ptr and keep whatever they change per run on their own side
+class ProgramImage
+{
+public:
+	ProgramImage(std::tuple<std::vector<Code>, std::map<std::string, std::size_t>> _objectCode)
+		: m_vecCode(std::move(std::get<0>(_objectCode))), m_mapFunctionTable(std::move(std::get<1>(_objectCode))) { }
+
+	static std::shared_ptr<const ProgramImage> Create(std::tuple<std::vector<Code>, std::map<std::string, std::size_t>> _objectCode)
+	{
+		return std::make_shared<const ProgramImage>(std::move(_objectCode));
+	}
+
+public:
+	const std::vector<Code> m_vecCode;
+	// Function name -> address of its Alloca
+	const std::map<std::string, std::size_t> m_mapFunctionTable;
+};
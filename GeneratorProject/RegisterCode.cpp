@@ -0,0 +1,41 @@
+#include "RegisterCode.h"
+
+namespace
+{
+	static std::map<RegisterInstruction, std::string> g_mapInstructionToStringTable
+	{
+#define _X(Code) { RegisterInstruction::Code, #Code },
+#include "RegisterCodeDefine.ini"
+#undef _X
+	};
+}
+
+std::string ToString(RegisterInstruction _instruction)
+{
+    if (g_mapInstructionToStringTable.count(_instruction)) {
+        return g_mapInstructionToStringTable.at(_instruction);
+    }
+    return "";
+}
+
+std::string PrintCode(RegisterCode& _code)
+{
+    std::string strResult = ToString(_code.m_instruction);
+    strResult += std::string(strResult.size() < 20 ? 20 - strResult.size() : 1, ' ');
+    strResult += "r" + std::to_string(_code.m_iA) + " r" + std::to_string(_code.m_iB) + " r" + std::to_string(_code.m_iC);
+
+    auto& type = _code.m_anyOperand.type();
+    if (type == typeid(uint64)) {
+        strResult += " [" + std::to_string(std::any_cast<uint64>(_code.m_anyOperand)) + "]";
+    }
+    else if (type == typeid(bool)) {
+        strResult += std::any_cast<bool>(_code.m_anyOperand) ? " true" : " false";
+    }
+    else if (type == typeid(float64)) {
+        strResult += " " + std::to_string(std::any_cast<float64>(_code.m_anyOperand));
+    }
+    else if (type == typeid(std::string)) {
+        strResult += " \"" + std::any_cast<std::string>(_code.m_anyOperand) + "\"";
+    }
+    return strResult;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <any>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <string>
+#include "TypeDefine.h"
+
+// Register form of Instruction, locals and operand stack slots of a frame are registers
+// and instructions name them. A is the destination unless noted
+enum class RegisterInstruction {
+	Exit,
+	// A : first of the argument registers, callee after the arguments, result in A
+	// B : argument count
+	Call, TailCall,
+	// A : first of the argument registers, B : argument count, C : index in Builtin, result in A
+	CallNative,
+	// A : registers of the frame, B : locals among them
+	Alloca,
+	// A : result, B : 0 when there is none
+	Return,
+	// A : memo slot, on a hit returns the cached result
+	// MemoStore B : result, C : 0 when there is none
+	MemoLoad, MemoStore,
+	// A : condition, LogicalOr/LogicalAnd leave it for the jump target
+	Jump, ConditionJump, LoopJump,
+	LogicalOr, LogicalAnd,
+	// A : first value, B : count
+	Print, PrintLine,
+
+	Move, LoadConstant,
+
+	// A = B op C
+	Add, Subtract,
+	Multiply, Divide, Modulo,
+	ShiftLeft,
+	Equal, NotEqual,
+	LessThan, GreaterThan,
+	LessOrEqual, GreaterOrEqual,
+	// A = op B
+	Absolute, ReverseSign,
+	ArrayLength, ArrayPop, Sqrt,
+	// A = push(B, C), B the array
+	ArrayPush,
+
+	// GetElement A = B[C], SetElement B[C] = A
+	GetElement, SetElement,
+	GetGlobal, SetGlobal,
+
+	// A : first element, B : count of elements or key value pairs, result in A
+	NewArray, NewMap,
+	NewScopedArray, NewScopedMap,
+
+	AddU64, SubtractU64, MultiplyU64,
+	EqualU64, NotEqualU64,
+	LessThanU64, GreaterThanU64,
+	LessOrEqualU64, GreaterOrEqualU64,
+	ConcatString,
+	GetElementArrayU64, SetElementArrayU64,
+};
+
+std::string ToString(RegisterInstruction _instruction);
+
+struct RegisterCode {
+	RegisterInstruction m_instruction;
+	uint32 m_iA = 0;
+	uint32 m_iB = 0;
+	uint32 m_iC = 0;
+	// Constant, global name or jump address
+	std::any m_anyOperand;
+};
+
+using RegisterObjectCode = std::tuple<std::vector<RegisterCode>, std::map<std::string, std::size_t>>;
+
+std::string PrintCode(RegisterCode& _code);
@@ -0,0 +1,447 @@
+#include <iostream>
+#include <algorithm>
+#include "RegisterGenerator.h"
+#include "Object.h"
+
+namespace
+{
+    // A = B op C, the operand stack form pops C then B and pushes A
+    static const std::map<Instruction, RegisterInstruction> g_mapBinaryTable =
+    {
+        { Instruction::Add,                 RegisterInstruction::Add },
+        { Instruction::Subtract,            RegisterInstruction::Subtract },
+        { Instruction::Multiply,            RegisterInstruction::Multiply },
+        { Instruction::Divide,              RegisterInstruction::Divide },
+        { Instruction::Modulo,              RegisterInstruction::Modulo },
+        { Instruction::ShiftLeft,           RegisterInstruction::ShiftLeft },
+        { Instruction::Equal,               RegisterInstruction::Equal },
+        { Instruction::NotEqual,            RegisterInstruction::NotEqual },
+        { Instruction::LessThan,            RegisterInstruction::LessThan },
+        { Instruction::GreaterThan,         RegisterInstruction::GreaterThan },
+        { Instruction::LessOrEqual,         RegisterInstruction::LessOrEqual },
+        { Instruction::GreaterOrEqual,      RegisterInstruction::GreaterOrEqual },
+        { Instruction::GetElement,          RegisterInstruction::GetElement },
+        { Instruction::AddU64,              RegisterInstruction::AddU64 },
+        { Instruction::SubtractU64,         RegisterInstruction::SubtractU64 },
+        { Instruction::MultiplyU64,         RegisterInstruction::MultiplyU64 },
+        { Instruction::EqualU64,            RegisterInstruction::EqualU64 },
+        { Instruction::NotEqualU64,         RegisterInstruction::NotEqualU64 },
+        { Instruction::LessThanU64,         RegisterInstruction::LessThanU64 },
+        { Instruction::GreaterThanU64,      RegisterInstruction::GreaterThanU64 },
+        { Instruction::LessOrEqualU64,      RegisterInstruction::LessOrEqualU64 },
+        { Instruction::GreaterOrEqualU64,   RegisterInstruction::GreaterOrEqualU64 },
+        { Instruction::ConcatString,        RegisterInstruction::ConcatString },
+        { Instruction::GetElementArrayU64,  RegisterInstruction::GetElementArrayU64 },
+    };
+
+    uint64 ToOperand(const Code& _code)
+    {
+        return Object::IsSize(_code.m_anyOperand) ? Object::ToSize(_code.m_anyOperand) : 0;
+    }
+
+    bool IsJump(RegisterInstruction _instruction)
+    {
+        return _instruction == RegisterInstruction::Jump ||
+            _instruction == RegisterInstruction::ConditionJump ||
+            _instruction == RegisterInstruction::LoopJump ||
+            _instruction == RegisterInstruction::LogicalOr ||
+            _instruction == RegisterInstruction::LogicalAnd;
+    }
+}
+
+RegisterObjectCode RegisterGenerator::Generate(const ProgramImage& _image)
+{
+    auto& vecCode = _image.m_vecCode;
+    auto& functionTable = _image.m_mapFunctionTable;
+    m_vecCode.clear();
+    m_mapCodeSize.clear();
+    m_vecAddress.assign(vecCode.size() + 1, 0);
+    m_vecDepth.assign(vecCode.size() + 1, SIZE_MAX);
+    m_vecTarget.assign(vecCode.size() + 1, false);
+
+    std::map<uint64, std::string> mapEntryTable = { { 0, "" } };
+    for (auto& [name, address] : functionTable) {
+        mapEntryTable[address] = name;
+    }
+    for (auto& code : vecCode) {
+        if (code.m_instruction == Instruction::Jump || code.m_instruction == Instruction::ConditionJump ||
+            code.m_instruction == Instruction::LoopJump || code.m_instruction == Instruction::LogicalOr ||
+            code.m_instruction == Instruction::LogicalAnd) {
+            m_vecTarget[ToOperand(code)] = true;
+        }
+    }
+
+    for (auto it = mapEntryTable.begin(); it != mapEntryTable.end(); ++it) {
+        uint64 end = std::next(it) == mapEntryTable.end() ? vecCode.size() : std::next(it)->first;
+        uint64 codeSize = m_vecCode.size();
+        GenerateFunction(vecCode, it->first, end);
+        if (it->second.empty() == false) {
+            m_mapCodeSize[it->second] = { end - it->first, m_vecCode.size() - codeSize };
+        }
+    }
+    m_vecAddress[vecCode.size()] = m_vecCode.size();
+
+    for (auto& code : m_vecCode) {
+        if (IsJump(code.m_instruction)) {
+            code.m_anyOperand = static_cast<uint64>(m_vecAddress[Object::ToSize(code.m_anyOperand)]);
+        }
+    }
+    std::map<std::string, std::size_t> mapFunctionTable;
+    for (auto& [name, address] : functionTable) {
+        mapFunctionTable[name] = m_vecAddress[address];
+    }
+    return { m_vecCode, mapFunctionTable };
+}
+
+std::string RegisterGenerator::PrintReport()
+{
+    std::string strResult;
+    for (auto& [name, size] : m_mapCodeSize) {
+        strResult += name + " : " + std::to_string(size.first) + " -> " + std::to_string(size.second) + " codes\n";
+    }
+    return strResult;
+}
+
+void RegisterGenerator::ComputeDepth(const std::vector<Code>& _vecCode, uint64 _begin, uint64 _end)
+{
+    std::vector<uint64> vecWork;
+    auto reach = [&](uint64 _index, uint64 _depth) {
+        if (_index >= _end) {
+            return;
+        }
+        if (m_vecDepth[_index] == SIZE_MAX) {
+            m_vecDepth[_index] = _depth;
+            vecWork.push_back(_index);
+        }
+        else if (m_vecDepth[_index] != _depth) {
+            std::cout << "operand stack depth differs at " << _index << "\n";
+            throw;
+        }
+    };
+
+    m_iMaxDepth = 0;
+    reach(_begin, 0);
+    while (vecWork.empty() == false) {
+        uint64 index = vecWork.back();
+        vecWork.pop_back();
+        const Code& code = _vecCode[index];
+        uint64 depth = m_vecDepth[index];
+        uint64 operand = ToOperand(code);
+        m_iMaxDepth = std::max(m_iMaxDepth, depth);
+
+        switch (code.m_instruction) {
+        case Instruction::Exit:
+        case Instruction::Return:
+            break;
+        case Instruction::Jump:
+            reach(operand, depth);
+            break;
+        case Instruction::ConditionJump:
+        case Instruction::LoopJump:
+            reach(index + 1, depth - 1);
+            reach(operand, depth - 1);
+            break;
+        case Instruction::LogicalOr:
+        case Instruction::LogicalAnd:
+            reach(index + 1, depth - 1);
+            reach(operand, depth);
+            break;
+        case Instruction::MemoLoad:
+            // MemoLoad, ConditionJump, Return become the one MemoLoad that returns on a hit
+            m_vecDepth[index + 1] = depth;
+            m_vecDepth[index + 2] = depth;
+            reach(ToOperand(_vecCode[index + 1]), depth);
+            break;
+        case Instruction::Call:
+        case Instruction::TailCall:
+        case Instruction::Print:
+            reach(index + 1, depth - operand);
+            break;
+        case Instruction::PushArray:
+        case Instruction::PushScopedArray:
+            reach(index + 1, depth + 1 - operand);
+            break;
+        case Instruction::PushMap:
+        case Instruction::PushScopedMap:
+            reach(index + 1, depth + 1 - operand * 2);
+            break;
+        case Instruction::SetElement:
+        case Instruction::SetElementArrayU64:
+            reach(index + 1, depth - 2);
+            break;
+        case Instruction::ArrayPush:
+            reach(index + 1, depth - 1);
+            break;
+        case Instruction::CallNative:
+            reach(index + 1, depth + 1 - BuiltinMgr.Get(operand).m_iArity);
+            break;
+        case Instruction::GetGlobal:
+        case Instruction::GetLocal:
+        case Instruction::PushNull:
+        case Instruction::PushBoolean:
+        case Instruction::PushNumber:
+        case Instruction::PushString:
+            reach(index + 1, depth + 1);
+            break;
+        case Instruction::PopOperand:
+            reach(index + 1, depth - 1);
+            break;
+        default:
+            reach(index + 1, g_mapBinaryTable.count(code.m_instruction) ? depth - 1 : depth);
+            break;
+        }
+    }
+}
+
+void RegisterGenerator::GenerateFunction(const std::vector<Code>& _vecCode, uint64 _begin, uint64 _end)
+{
+    ComputeDepth(_vecCode, _begin, _end);
+    m_iLocalSize = _vecCode[_begin].m_instruction == Instruction::Alloca ? ToOperand(_vecCode[_begin]) : 0;
+    m_vecOperand.clear();
+    m_iLastWrite = SIZE_MAX;
+    uint64 alloca = Emit(RegisterInstruction::Alloca, 0, static_cast<uint32>(m_iLocalSize));
+    m_vecAddress[_begin] = alloca;
+
+    bool bFallThrough = false;
+    for (uint64 i = _begin; i < _end; ++i) {
+        const Code& code = _vecCode[i];
+        uint64 operand = ToOperand(code);
+        if (m_vecDepth[i] == SIZE_MAX) {
+            m_vecAddress[i] = m_vecCode.size();
+            bFallThrough = false;
+            continue;
+        }
+        if (m_vecTarget[i] || bFallThrough == false) {
+            // Every way into a jump target finds the operand stack in its own registers
+            if (bFallThrough) {
+                Materialize(0);
+            }
+            m_vecOperand.clear();
+            for (uint64 k = 0; k < m_vecDepth[i]; ++k) {
+                m_vecOperand.push_back(Temporary(k));
+            }
+            m_iLastWrite = SIZE_MAX;
+        }
+        if (i != _begin) {
+            m_vecAddress[i] = m_vecCode.size();
+        }
+        bFallThrough = true;
+
+        auto findIt = g_mapBinaryTable.find(code.m_instruction);
+        if (findIt != g_mapBinaryTable.end()) {
+            uint32 rhs = Pop();
+            uint32 lhs = Pop();
+            EmitPush(findIt->second, lhs, rhs);
+            continue;
+        }
+        switch (code.m_instruction) {
+        case Instruction::Alloca:
+            break;
+        case Instruction::Exit:
+            Emit(RegisterInstruction::Exit);
+            bFallThrough = false;
+            break;
+        case Instruction::Return:
+            if (m_vecOperand.empty()) {
+                Emit(RegisterInstruction::Return);
+            }
+            else {
+                Emit(RegisterInstruction::Return, m_vecOperand.back(), 1);
+            }
+            bFallThrough = false;
+            break;
+        case Instruction::Call:
+        case Instruction::TailCall:
+            {
+                uint64 base = m_vecOperand.size() - operand - 1;
+                Materialize(base);
+                m_vecOperand.resize(base);
+                Emit(code.m_instruction == Instruction::Call ? RegisterInstruction::Call : RegisterInstruction::TailCall,
+                    Temporary(base), static_cast<uint32>(operand));
+                m_vecOperand.push_back(Temporary(base));
+            }
+            break;
+        case Instruction::MemoLoad:
+            Emit(RegisterInstruction::MemoLoad, static_cast<uint32>(operand));
+            m_vecAddress[i + 1] = m_vecCode.size();
+            m_vecAddress[i + 2] = m_vecCode.size();
+            i += 2;
+            break;
+        case Instruction::MemoStore:
+            if (m_vecOperand.empty()) {
+                Emit(RegisterInstruction::MemoStore, static_cast<uint32>(operand));
+            }
+            else {
+                Emit(RegisterInstruction::MemoStore, static_cast<uint32>(operand), m_vecOperand.back(), 1);
+            }
+            break;
+        case Instruction::Jump:
+            Materialize(0);
+            Emit(RegisterInstruction::Jump, 0, 0, 0, operand);
+            bFallThrough = false;
+            break;
+        case Instruction::ConditionJump:
+        case Instruction::LoopJump:
+            {
+                uint32 condition = Pop();
+                Materialize(0);
+                Emit(code.m_instruction == Instruction::LoopJump ? RegisterInstruction::LoopJump : RegisterInstruction::ConditionJump,
+                    condition, 0, 0, operand);
+            }
+            break;
+        case Instruction::LogicalOr:
+        case Instruction::LogicalAnd:
+            // The value stays for the jump target and is dropped on the way through
+            Materialize(0);
+            Emit(code.m_instruction == Instruction::LogicalOr ? RegisterInstruction::LogicalOr : RegisterInstruction::LogicalAnd,
+                m_vecOperand.back(), 0, 0, operand);
+            Pop();
+            break;
+        case Instruction::Print:
+            {
+                uint64 base = m_vecOperand.size() - operand;
+                Materialize(base);
+                m_vecOperand.resize(base);
+                Emit(RegisterInstruction::Print, Temporary(base), static_cast<uint32>(operand));
+            }
+            break;
+        case Instruction::PrintLine:
+            Emit(RegisterInstruction::PrintLine);
+            break;
+        case Instruction::CallNative:
+            {
+                uint64 arity = BuiltinMgr.Get(operand).m_iArity;
+                uint64 base = m_vecOperand.size() - arity;
+                Materialize(base);
+                m_vecOperand.resize(base);
+                Emit(RegisterInstruction::CallNative, Temporary(base), static_cast<uint32>(arity), static_cast<uint32>(operand));
+                m_vecOperand.push_back(Temporary(base));
+            }
+            break;
+        case Instruction::Absolute:
+        case Instruction::ReverseSign:
+            EmitPush(code.m_instruction == Instruction::Absolute ? RegisterInstruction::Absolute : RegisterInstruction::ReverseSign, Pop());
+            break;
+        case Instruction::ArrayLength:
+            EmitPush(RegisterInstruction::ArrayLength, Pop());
+            break;
+        case Instruction::ArrayPop:
+            EmitPush(RegisterInstruction::ArrayPop, Pop());
+            break;
+        case Instruction::Sqrt:
+            EmitPush(RegisterInstruction::Sqrt, Pop());
+            break;
+        case Instruction::ArrayPush:
+            {
+                uint32 sub = Pop();
+                uint32 value = Pop();
+                EmitPush(RegisterInstruction::ArrayPush, sub, value);
+            }
+            break;
+        case Instruction::SetElement:
+        case Instruction::SetElementArrayU64:
+            {
+                uint32 index = Pop();
+                uint32 sub = Pop();
+                Emit(code.m_instruction == Instruction::SetElement ? RegisterInstruction::SetElement : RegisterInstruction::SetElementArrayU64,
+                    m_vecOperand.back(), sub, index);
+            }
+            break;
+        case Instruction::GetGlobal:
+            EmitPush(RegisterInstruction::GetGlobal, 0, 0, code.m_anyOperand);
+            break;
+        case Instruction::SetGlobal:
+            Emit(RegisterInstruction::SetGlobal, m_vecOperand.back(), 0, 0, code.m_anyOperand);
+            break;
+        case Instruction::GetLocal:
+            m_vecOperand.push_back(static_cast<uint32>(operand));
+            break;
+        case Instruction::SetLocal:
+            {
+                uint32 local = static_cast<uint32>(operand);
+                uint32 value = m_vecOperand.back();
+                if (value == local) {
+                    break;
+                }
+                // Operands still reading the old value of the local get their own copy first
+                for (uint64 k = 0; k + 1 < m_vecOperand.size(); ++k) {
+                    if (m_vecOperand[k] == local) {
+                        Emit(RegisterInstruction::Move, Temporary(k), local);
+                        m_vecOperand[k] = Temporary(k);
+                    }
+                }
+                if (m_iLastWrite == m_vecCode.size() - 1 && m_vecCode.back().m_iA == value) {
+                    m_vecCode.back().m_iA = local;
+                }
+                else {
+                    Emit(RegisterInstruction::Move, local, value);
+                }
+                m_vecOperand.back() = local;
+                m_iLastWrite = SIZE_MAX;
+            }
+            break;
+        case Instruction::PushNull:
+            EmitPush(RegisterInstruction::LoadConstant, 0, 0, std::any(nullptr));
+            break;
+        case Instruction::PushBoolean:
+        case Instruction::PushNumber:
+        case Instruction::PushString:
+            EmitPush(RegisterInstruction::LoadConstant, 0, 0, code.m_anyOperand);
+            break;
+        case Instruction::PushArray:
+        case Instruction::PushScopedArray:
+        case Instruction::PushMap:
+        case Instruction::PushScopedMap:
+            {
+                static const std::map<Instruction, RegisterInstruction> mapNewTable = {
+                    { Instruction::PushArray,       RegisterInstruction::NewArray },
+                    { Instruction::PushScopedArray, RegisterInstruction::NewScopedArray },
+                    { Instruction::PushMap,         RegisterInstruction::NewMap },
+                    { Instruction::PushScopedMap,   RegisterInstruction::NewScopedMap },
+                };
+                bool bMap = code.m_instruction == Instruction::PushMap || code.m_instruction == Instruction::PushScopedMap;
+                uint64 base = m_vecOperand.size() - (bMap ? operand * 2 : operand);
+                Materialize(base);
+                m_vecOperand.resize(base);
+                Emit(mapNewTable.at(code.m_instruction), Temporary(base), static_cast<uint32>(operand));
+                m_vecOperand.push_back(Temporary(base));
+            }
+            break;
+        case Instruction::PopOperand:
+            Pop();
+            break;
+        }
+    }
+    m_vecCode[alloca].m_iA = Temporary(m_iMaxDepth);
+}
+
+uint64 RegisterGenerator::Emit(RegisterInstruction _instruction, uint32 _a, uint32 _b, uint32 _c, std::any _anyOperand)
+{
+    m_vecCode.push_back({ _instruction, _a, _b, _c, std::move(_anyOperand) });
+    m_iLastWrite = SIZE_MAX;
+    return m_vecCode.size() - 1;
+}
+
+void RegisterGenerator::EmitPush(RegisterInstruction _instruction, uint32 _b, uint32 _c, std::any _anyOperand)
+{
+    uint32 result = Temporary(m_vecOperand.size());
+    m_iLastWrite = Emit(_instruction, result, _b, _c, std::move(_anyOperand));
+    m_vecOperand.push_back(result);
+}
+
+void RegisterGenerator::Materialize(uint64 _depth)
+{
+    for (uint64 k = _depth; k < m_vecOperand.size(); ++k) {
+        if (m_vecOperand[k] != Temporary(k)) {
+            Emit(RegisterInstruction::Move, Temporary(k), m_vecOperand[k]);
+            m_vecOperand[k] = Temporary(k);
+        }
+    }
+}
+
+uint32 RegisterGenerator::Pop()
+{
+    uint32 result = m_vecOperand.back();
+    m_vecOperand.pop_back();
+    return result;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include <string>
+#include "TypeDefine.h"
+#include "Code.h"
+#include "RegisterCode.h"
+#include "ProgramImage.h"
+
+// Lowers the finished stack code of Generater into RegisterCode for the RegisterMachine.
+// Operand stack slot n of a frame becomes register locals + n, a GetLocal is not copied
+// until something would overwrite the local and a SetLocal takes over the register the value was computed into
+class RegisterGenerator
+{
+private:
+	RegisterGenerator() { }
+	~RegisterGenerator() { }
+public:
+	static RegisterGenerator& GetInstance()
+	{
+		static thread_local RegisterGenerator instance;
+		return instance;
+	}
+#define RegisterGeneratorMgr		RegisterGenerator::GetInstance()
+
+public:
+	RegisterObjectCode Generate(const ProgramImage& _image);
+	std::string PrintReport();
+
+private:
+	// Code of one function is [_begin, _end), its Alloca first, the code before the first function has none
+	void GenerateFunction(const std::vector<Code>& _vecCode, uint64 _begin, uint64 _end);
+	// Operand stack depth before each instruction, SIZE_MAX where nothing reaches
+	void ComputeDepth(const std::vector<Code>& _vecCode, uint64 _begin, uint64 _end);
+
+	uint32 Temporary(uint64 _depth) const { return static_cast<uint32>(m_iLocalSize + _depth); }
+	uint64 Emit(RegisterInstruction _instruction, uint32 _a = 0, uint32 _b = 0, uint32 _c = 0, std::any _anyOperand = std::any());
+	// Writes A = ... and pushes A as the new top of the operand stack
+	void EmitPush(RegisterInstruction _instruction, uint32 _b = 0, uint32 _c = 0, std::any _anyOperand = std::any());
+	// Copies the operand stack from _depth up into its own registers, every jump and jump target expects them there
+	void Materialize(uint64 _depth);
+	uint32 Pop();
+
+private:
+	std::vector<RegisterCode> m_vecCode;
+	// Stack code address -> register code address
+	std::vector<uint64> m_vecAddress;
+	std::vector<uint64> m_vecDepth;
+	std::vector<bool> m_vecTarget;
+	// Register holding each operand stack slot, a local until it is materialized
+	std::vector<uint32> m_vecOperand;
+	uint64 m_iLocalSize = 0;
+	uint64 m_iMaxDepth = 0;
+	// Last instruction whose A only receives a result, a following SetLocal may redirect it
+	uint64 m_iLastWrite = SIZE_MAX;
+
+public:
+	// Function name -> instructions before and after the last Generate
+	std::map<std::string, std::pair<uint64, uint64>> m_mapCodeSize;
+};
@@ -0,0 +1,439 @@
+#include <algorithm>
+#include <cmath>
+#include "RegisterMachine.h"
+#include "Object.h"
+#include "Operator.h"
+#include "Application.h"
+
+void RegisterMachine::Execute(const RegisterObjectCode& _objectCode)
+{
+    auto& [vecCodeList, functionTable] = _objectCode;
+    m_mapGlobal.clear();
+    m_vecObject.clear();
+    m_memoCache.Clear();
+    m_strOutput.clear();
+    m_vecCallStack.clear();
+    m_vecCallStack.emplace_back();
+    while (true)
+    {
+        RegisterFrame& frame = m_vecCallStack.back();
+        const RegisterCode& code = vecCodeList[frame.m_instructionPointer];
+        std::any* r = frame.m_vecRegister.data();
+        switch (code.m_instruction)
+        {
+        case RegisterInstruction::Exit:
+            {
+                m_vecCallStack.pop_back();
+            }
+            return;
+        case RegisterInstruction::Call:
+        case RegisterInstruction::TailCall:
+            {
+                // Arguments are in pushed order, the last one first, the callee after them
+                auto& callee = r[code.m_iA + code.m_iB];
+                if (Object::IsSize(callee))
+                {
+                    auto address = Object::ToSize(callee);
+                    const RegisterCode& alloca = vecCodeList[address];
+                    std::vector<std::any> vecRegister(std::max(alloca.m_iA, code.m_iB));
+                    for (uint32 i = 0; i < code.m_iB; i++) {
+                        vecRegister[i] = r[code.m_iA + code.m_iB - 1 - i];
+                    }
+                    // The Alloca is done here, the callee starts after it
+                    if (code.m_instruction == RegisterInstruction::TailCall) {
+                        frame.m_vecRegister = std::move(vecRegister);
+                        frame.m_instructionPointer = address + 1;
+                        continue;
+                    }
+                    RegisterFrame callFrame;
+                    callFrame.m_vecRegister = std::move(vecRegister);
+                    callFrame.m_instructionPointer = address + 1;
+                    callFrame.m_iResult = code.m_iA;
+                    m_vecCallStack.push_back(std::move(callFrame));
+                    continue;
+                }
+                if (Object::IsBuiltinFunction(callee)) {
+                    std::any result;
+                    Object::ToBuiltinFunction(callee)(NativeArgument(r + code.m_iA + code.m_iB - 1, code.m_iB, -1), result);
+                    r[code.m_iA] = std::move(result);
+                    break;
+                }
+                r[code.m_iA] = nullptr;
+            }
+            break;
+        case RegisterInstruction::CallNative:
+            {
+                std::any result;
+                BuiltinMgr.Get(code.m_iC).m_function(NativeArgument(r + code.m_iA + code.m_iB - 1, code.m_iB, -1), result);
+                r[code.m_iA] = std::move(result);
+            }
+            break;
+        case RegisterInstruction::Alloca:
+            {
+                frame.m_vecRegister.resize(code.m_iA);
+            }
+            break;
+        case RegisterInstruction::Return:
+            {
+                ReturnValue(code.m_iB ? r[code.m_iA] : std::any(nullptr));
+            }
+            break;
+        case RegisterInstruction::MemoLoad:
+            {
+                std::any result;
+                if (m_memoCache.Load(frame.m_instructionPointer, r, code.m_iA, functionTable, result)) {
+                    ReturnValue(std::move(result));
+                    break;
+                }
+                r[code.m_iA] = std::move(result);
+            }
+            break;
+        case RegisterInstruction::MemoStore:
+            {
+                m_memoCache.Store(r[code.m_iA], code.m_iC ? r[code.m_iB] : std::any(nullptr));
+            }
+            break;
+        case RegisterInstruction::Jump:
+            {
+                frame.m_instructionPointer = Object::ToSize(code.m_anyOperand);
+            }
+            continue;
+        case RegisterInstruction::ConditionJump:
+            {
+                if (Object::IsTrue(r[code.m_iA])) {
+                    break;
+                }
+                frame.m_instructionPointer = Object::ToSize(code.m_anyOperand);
+            }
+            continue;
+        case RegisterInstruction::LoopJump:
+        case RegisterInstruction::LogicalOr:
+            {
+                if (Object::IsTrue(r[code.m_iA]) == false) {
+                    break;
+                }
+                frame.m_instructionPointer = Object::ToSize(code.m_anyOperand);
+            }
+            continue;
+        case RegisterInstruction::LogicalAnd:
+            {
+                if (Object::IsFalse(r[code.m_iA]) == false) {
+                    break;
+                }
+                frame.m_instructionPointer = Object::ToSize(code.m_anyOperand);
+            }
+            continue;
+        case RegisterInstruction::Print:
+            {
+                for (uint32 i = 0; i < code.m_iB; i++) {
+                    auto& value = r[code.m_iA + code.m_iB - 1 - i];
+                    m_strOutput += AnyToString(value);
+                }
+            }
+            break;
+        case RegisterInstruction::PrintLine:
+            {
+                m_strOutput += '\n';
+            }
+            break;
+        case RegisterInstruction::Move:
+            {
+                r[code.m_iA] = r[code.m_iB];
+            }
+            break;
+        case RegisterInstruction::LoadConstant:
+            {
+                r[code.m_iA] = code.m_anyOperand;
+            }
+            break;
+        case RegisterInstruction::Add:              r[code.m_iA] = Operate<EOperator::Add>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::Subtract:         r[code.m_iA] = Operate<EOperator::Subtract>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::Multiply:         r[code.m_iA] = Operate<EOperator::Multiply>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::Divide:           r[code.m_iA] = Operate<EOperator::Divide>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::Modulo:           r[code.m_iA] = Operate<EOperator::Modulo>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::Equal:            r[code.m_iA] = Operate<EOperator::Equal>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::NotEqual:         r[code.m_iA] = Operate<EOperator::NotEqual>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::LessThan:         r[code.m_iA] = Operate<EOperator::LessThan>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::GreaterThan:      r[code.m_iA] = Operate<EOperator::GreaterThan>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::LessOrEqual:      r[code.m_iA] = Operate<EOperator::LessOrEqual>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::GreaterOrEqual:   r[code.m_iA] = Operate<EOperator::GreaterOrEqual>(r[code.m_iB], r[code.m_iC]); break;
+        case RegisterInstruction::ShiftLeft:
+            {
+                auto& lValue = r[code.m_iB];
+                auto& rValue = r[code.m_iC];
+                if (Object::IsNumber(lValue)) {
+                    r[code.m_iA] = Object::ToNumber(lValue) << Object::ToNumber(rValue);
+                }
+                else {
+                    // Peephole only emits this for a power of two multiplier, multiply by it for other types
+                    r[code.m_iA] = Operate(EOperator::Multiply, lValue, static_cast<uint64>(1) << Object::ToNumber(rValue));
+                }
+            }
+            break;
+        case RegisterInstruction::AddU64:
+        case RegisterInstruction::SubtractU64:
+        case RegisterInstruction::MultiplyU64:
+        case RegisterInstruction::EqualU64:
+        case RegisterInstruction::NotEqualU64:
+        case RegisterInstruction::LessThanU64:
+        case RegisterInstruction::GreaterThanU64:
+        case RegisterInstruction::LessOrEqualU64:
+        case RegisterInstruction::GreaterOrEqualU64:
+            {
+                static const std::map<RegisterInstruction, EOperator> mapOperatorTable = {
+                    { RegisterInstruction::AddU64,              EOperator::Add },
+                    { RegisterInstruction::SubtractU64,         EOperator::Subtract },
+                    { RegisterInstruction::MultiplyU64,         EOperator::Multiply },
+                    { RegisterInstruction::EqualU64,            EOperator::Equal },
+                    { RegisterInstruction::NotEqualU64,         EOperator::NotEqual },
+                    { RegisterInstruction::LessThanU64,         EOperator::LessThan },
+                    { RegisterInstruction::GreaterThanU64,      EOperator::GreaterThan },
+                    { RegisterInstruction::LessOrEqualU64,      EOperator::LessOrEqual },
+                    { RegisterInstruction::GreaterOrEqualU64,   EOperator::GreaterOrEqual },
+                };
+                auto& lValue = r[code.m_iB];
+                auto& rValue = r[code.m_iC];
+                // Same fall back as Machine for a profiled guess that turns out wrong
+                if (Object::IsNumber(lValue) == false || Object::IsNumber(rValue) == false) {
+                    r[code.m_iA] = Operate(mapOperatorTable.at(code.m_instruction), lValue, rValue);
+                    break;
+                }
+                uint64 lhs = Object::ToNumber(lValue);
+                uint64 rhs = Object::ToNumber(rValue);
+                switch (code.m_instruction)
+                {
+                case RegisterInstruction::AddU64:               r[code.m_iA] = lhs + rhs; break;
+                case RegisterInstruction::SubtractU64:          r[code.m_iA] = lhs - rhs; break;
+                case RegisterInstruction::MultiplyU64:          r[code.m_iA] = lhs * rhs; break;
+                case RegisterInstruction::EqualU64:             r[code.m_iA] = lhs == rhs; break;
+                case RegisterInstruction::NotEqualU64:          r[code.m_iA] = lhs != rhs; break;
+                case RegisterInstruction::LessThanU64:          r[code.m_iA] = lhs < rhs; break;
+                case RegisterInstruction::GreaterThanU64:       r[code.m_iA] = lhs > rhs; break;
+                case RegisterInstruction::LessOrEqualU64:       r[code.m_iA] = lhs <= rhs; break;
+                case RegisterInstruction::GreaterOrEqualU64:    r[code.m_iA] = lhs >= rhs; break;
+                }
+            }
+            break;
+        case RegisterInstruction::ConcatString:
+            {
+                r[code.m_iA] = Object::ToString(r[code.m_iB]) + Object::ToString(r[code.m_iC]);
+            }
+            break;
+        case RegisterInstruction::Absolute:
+            {
+                auto& value = r[code.m_iB];
+                r[code.m_iA] = Object::IsNumber(value) ? std::any(Object::ToNumber(value)) : std::any(0.0);
+            }
+            break;
+        case RegisterInstruction::ReverseSign:
+            {
+                auto& value = r[code.m_iB];
+                r[code.m_iA] = Object::IsNumber(value) ? std::any(Object::ToNumber(value) * -1) : std::any(0.0);
+            }
+            break;
+        case RegisterInstruction::ArrayLength:
+            {
+                auto& sub = r[code.m_iB];
+                if (Object::IsArray(sub)) {
+                    r[code.m_iA] = static_cast<float64>(Object::ToArray(sub)->m_vecValue.size());
+                }
+                else if (Object::IsMap(sub)) {
+                    r[code.m_iA] = static_cast<float64>(Object::ToMap(sub)->m_mapValue.size());
+                }
+                else {
+                    r[code.m_iA] = 0.0;
+                }
+            }
+            break;
+        case RegisterInstruction::ArrayPop:
+            {
+                auto sub = r[code.m_iB];
+                if (Object::IsArray(sub) && Object::ToArray(sub)->m_vecValue.empty() == false) {
+                    r[code.m_iA] = Object::ToArray(sub)->m_vecValue.back();
+                    Object::ToArray(sub)->m_vecValue.pop_back();
+                }
+                else {
+                    r[code.m_iA] = nullptr;
+                }
+            }
+            break;
+        case RegisterInstruction::Sqrt:
+            {
+                auto& value = r[code.m_iB];
+                if (Object::IsNumber(value)) {
+                    r[code.m_iA] = std::sqrt(static_cast<float64>(Object::ToNumber(value)));
+                }
+                else if (Object::IsFloat(value)) {
+                    r[code.m_iA] = std::sqrt(Object::ToFloat(value));
+                }
+                else {
+                    r[code.m_iA] = 0.0;
+                }
+            }
+            break;
+        case RegisterInstruction::ArrayPush:
+            {
+                auto sub = r[code.m_iB];
+                if (Object::IsArray(sub)) {
+                    Object::ToArray(sub)->m_vecValue.push_back(r[code.m_iC]);
+                    r[code.m_iA] = sub;
+                }
+                else {
+                    r[code.m_iA] = nullptr;
+                }
+            }
+            break;
+        case RegisterInstruction::GetElement:
+            {
+                auto& sub = r[code.m_iB];
+                auto& index = r[code.m_iC];
+                if (Object::IsArray(sub) && Object::IsNumber(index)) {
+                    r[code.m_iA] = Object::GetValueOfArray(sub, index);
+                }
+                else if (Object::IsMap(sub) && Object::IsString(index)) {
+                    r[code.m_iA] = Object::GetValueOfMap(sub, index);
+                }
+                else {
+                    r[code.m_iA] = nullptr;
+                }
+            }
+            break;
+        case RegisterInstruction::SetElement:
+            {
+                auto& sub = r[code.m_iB];
+                auto& index = r[code.m_iC];
+                if (Object::IsArray(sub) && Object::IsNumber(index)) {
+                    Object::SetValueOfArray(sub, index, r[code.m_iA]);
+                }
+                else if (Object::IsMap(sub) && Object::IsString(index)) {
+                    Object::SetValueOfMap(sub, index, r[code.m_iA]);
+                }
+            }
+            break;
+        case RegisterInstruction::GetElementArrayU64:
+            {
+                r[code.m_iA] = Object::GetValueOfArray(r[code.m_iB], r[code.m_iC]);
+            }
+            break;
+        case RegisterInstruction::SetElementArrayU64:
+            {
+                Object::SetValueOfArray(r[code.m_iB], r[code.m_iC], r[code.m_iA]);
+            }
+            break;
+        case RegisterInstruction::GetGlobal:
+            {
+                auto name = Object::ToString(code.m_anyOperand);
+                auto functionIt = functionTable.find(name);
+                if (m_mapGlobal.count(name)) {
+                    r[code.m_iA] = m_mapGlobal[name];
+                }
+                else if (functionIt != functionTable.end()) {
+                    r[code.m_iA] = functionIt->second;
+                }
+                else if (uint64 native = BuiltinMgr.Find(name); native != SIZE_MAX) {
+                    r[code.m_iA] = BuiltinMgr.Get(native).m_function;
+                }
+                else {
+                    r[code.m_iA] = nullptr;
+                }
+            }
+            break;
+        case RegisterInstruction::SetGlobal:
+            {
+                m_mapGlobal[Object::ToString(code.m_anyOperand)] = r[code.m_iA];
+            }
+            break;
+        case RegisterInstruction::NewArray:
+        case RegisterInstruction::NewScopedArray:
+            {
+                auto pResult = std::make_shared<Array>();
+                for (uint32 i = code.m_iB; i > 0; i--) {
+                    pResult->m_vecValue.push_back(r[code.m_iA + i - 1]);
+                }
+                r[code.m_iA] = pResult;
+                // Scoped objects live only in the registers of this frame and go away with them
+                if (code.m_instruction == RegisterInstruction::NewArray) {
+                    m_vecObject.push_back(pResult);
+                }
+            }
+            break;
+        case RegisterInstruction::NewMap:
+        case RegisterInstruction::NewScopedMap:
+            {
+                auto pResult = std::make_shared<Map>();
+                for (uint32 i = code.m_iB; i > 0; i--) {
+                    auto& value = r[code.m_iA + i * 2 - 1];
+                    auto key = Object::ToString(r[code.m_iA + i * 2 - 2]);
+                    pResult->m_mapValue[key] = value;
+                }
+                r[code.m_iA] = pResult;
+                if (code.m_instruction == RegisterInstruction::NewMap) {
+                    m_vecObject.push_back(pResult);
+                }
+            }
+            break;
+        }
+        m_vecCallStack.back().m_instructionPointer += 1;
+    }
+}
+
+void RegisterMachine::ReturnValue(std::any _anyResult)
+{
+	uint32 result = m_vecCallStack.back().m_iResult;
+	m_vecCallStack.pop_back();
+	m_vecCallStack.back().m_vecRegister[result] = std::move(_anyResult);
+	CollectGarbage();
+}
+
+void RegisterMachine::CollectGarbage()
+{
+	m_iMarkEpoch += 1;
+	for (RegisterFrame& frame : m_vecCallStack)
+	{
+		for (auto& value : frame.m_vecRegister)
+		{
+			MarkObject(value);
+		}
+	}
+	for (auto& [key, value] : m_mapGlobal)
+	{
+		MarkObject(value);
+	}
+	SweepObject();
+}
+
+void RegisterMachine::MarkObject(const std::any& _object)
+{
+	if (Object::IsArray(_object))
+	{
+		if (Object::ToArray(_object)->m_iMark == m_iMarkEpoch)
+		{
+			return;
+		}
+		Object::ToArray(_object)->m_iMark = m_iMarkEpoch;
+		for (auto& value : Object::ToArray(_object)->m_vecValue)
+		{
+			MarkObject(value);
+		}
+	}
+	else if (Object::IsMap(_object))
+	{
+		if (Object::ToMap(_object)->m_iMark == m_iMarkEpoch)
+		{
+			return;
+		}
+		Object::ToMap(_object)->m_iMark = m_iMarkEpoch;
+		for (auto& [key, value] : Object::ToMap(_object)->m_mapValue)
+		{
+			MarkObject(value);
+		}
+	}
+}
+
+void RegisterMachine::SweepObject()
+{
+	m_vecObject.remove_if([this](const std::shared_ptr<Object>& _pObject)
+	{
+		return _pObject->m_iMark != m_iMarkEpoch;
+	});
+}
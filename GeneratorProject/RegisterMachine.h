@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <list>
+#include <any>
+#include <map>
+#include <string>
+#include <functional>
+#include "TypeDefine.h"
+#include "RegisterCode.h"
+#include "Machine.h"
+
+struct RegisterFrame
+{
+public:
+	std::vector<std::any> m_vecRegister;
+	std::size_t m_instructionPointer = 0;
+	// Register of the caller the Return writes to
+	uint32 m_iResult = 0;
+};
+
+// Runs the RegisterCode of RegisterGenerator, same values, objects and memo tables as Machine
+class RegisterMachine
+{
+public:
+	RegisterMachine() { }
+	__forceinline static RegisterMachine& GetInstance()
+	{
+		static thread_local RegisterMachine instance;
+		return instance;
+	}
+
+public:
+	void Execute(const RegisterObjectCode& _objectCode);
+
+public:
+	MemoCache m_memoCache;
+	// Text of Print and PrintLine since the last Execute, shown by the UI thread as the Machine's
+	std::string m_strOutput;
+
+private:
+	// Leaves the running frame with the result for the register its caller named
+	void ReturnValue(std::any _anyResult);
+	void CollectGarbage();
+	void MarkObject(const std::any& _object);
+	void SweepObject();
+
+private:
+	std::list<std::shared_ptr<Object>> m_vecObject;
+	// Bumped by each CollectGarbage, an object is reachable when its m_iMark caught up with it
+	uint64 m_iMarkEpoch = 0;
+	std::map<std::string, std::any> m_mapGlobal;
+	std::vector<RegisterFrame> m_vecCallStack;
+};
@@ -23,7 +23,9 @@ void ResultConsoleView::PostUpdate()
 	if (pMainView == nullptr) {
 		return;
 	}
-	pMainView->Interpret();
+	// Only the UI thread draws, the machine leaves what the script printed in its own buffer
+	std::string strOutput = pMainView->Interpret();
+	ImGui::TextUnformatted(strOutput.c_str());
 }
 
 void ResultConsoleView::End()
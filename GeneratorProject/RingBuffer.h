@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "TypeDefine.h"
+
+// Lock-free single producer / single consumer queue, one thread pushes and one thread pops
+template<typename T, uint64 Capacity>
+class RingBuffer
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "RingBuffer capacity must be a power of two");
+
+public:
+	RingBuffer() : m_vecBuffer(Capacity) { }
+
+public:
+	bool TryPush(T&& _value)
+	{
+		uint64 tail = m_iTail.load(std::memory_order_relaxed);
+		if (tail - m_iHead.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+		m_vecBuffer[tail & (Capacity - 1)] = std::move(_value);
+		m_iTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPop(T& _value)
+	{
+		uint64 head = m_iHead.load(std::memory_order_relaxed);
+		if (head == m_iTail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		_value = std::move(m_vecBuffer[head & (Capacity - 1)]);
+		m_iHead.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	void Push(T _value)
+	{
+		while (TryPush(std::move(_value)) == false) {
+			std::this_thread::yield();
+		}
+	}
+
+	T Pop()
+	{
+		T value;
+		while (TryPop(value) == false) {
+			std::this_thread::yield();
+		}
+		return value;
+	}
+
+private:
+	std::vector<T> m_vecBuffer;
+	alignas(64) std::atomic<uint64> m_iHead = 0;
+	alignas(64) std::atomic<uint64> m_iTail = 0;
+};
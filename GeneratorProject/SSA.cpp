@@ -0,0 +1,1214 @@
+#include <set>
+#include <algorithm>
+#include <unordered_set>
+#include "SSA.h"
+#include "SSAPass.h"
+#include "Escape.h"
+#include "TypeInference.h"
+#include "Object.h"
+
+namespace
+{
+    Instruction ToInstruction(EOperator _eOperator)
+    {
+        static const std::map<EOperator, Instruction> mapOperatorToInstructionTable = {
+            { EOperator::Add,            Instruction::Add },
+            { EOperator::Subtract,       Instruction::Subtract },
+            { EOperator::Multiply,       Instruction::Multiply },
+            { EOperator::Divide,         Instruction::Divide },
+            { EOperator::Modulo,         Instruction::Modulo },
+            { EOperator::Equal,          Instruction::Equal },
+            { EOperator::NotEqual,       Instruction::NotEqual },
+            { EOperator::LessThan,       Instruction::LessThan },
+            { EOperator::GreaterThan,    Instruction::GreaterThan },
+            { EOperator::LessOrEqual,    Instruction::LessOrEqual },
+            { EOperator::GreaterOrEqual, Instruction::GreaterOrEqual },
+        };
+        return mapOperatorToInstructionTable.at(_eOperator);
+    }
+
+    const char* ToString(ESSAOpcode _eOpcode)
+    {
+        static const char* arrOpcodeName[] = {
+            "undefined", "constant", "parameter", "phi", "binary", "absolute", "reverse_sign",
+            "get_global", "set_global", "get_element", "set_element", "call", "make_array", "make_map",
+            "print", "print_line", "jump", "branch", "branch_false", "return",
+        };
+        return arrOpcodeName[static_cast<uint64>(_eOpcode)];
+    }
+
+    template<typename T>
+    void EraseOne(std::vector<T>& _vec, const T& _value)
+    {
+        auto findIt = std::find(_vec.begin(), _vec.end(), _value);
+        if (findIt != _vec.end()) {
+            _vec.erase(findIt);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SSAValue
+bool SSAValue::IsTerminator() const
+{
+    return m_eOpcode >= ESSAOpcode::Jump;
+}
+
+bool SSAValue::HasSideEffect() const
+{
+    return m_eOpcode == ESSAOpcode::SetGlobal ||
+        m_eOpcode == ESSAOpcode::SetElement ||
+        m_eOpcode == ESSAOpcode::Call ||
+        m_eOpcode == ESSAOpcode::Print ||
+        m_eOpcode == ESSAOpcode::PrintLine;
+}
+
+bool SSAValue::ReadsMemory() const
+{
+    return m_eOpcode == ESSAOpcode::GetGlobal || m_eOpcode == ESSAOpcode::GetElement;
+}
+
+bool SSAValue::HasResult() const
+{
+    return IsTerminator() == false && m_eOpcode != ESSAOpcode::Print && m_eOpcode != ESSAOpcode::PrintLine;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SSABlock
+SSAValue* SSABlock::Terminator() const
+{
+    if (m_vecValue.empty() || m_vecValue.back()->IsTerminator() == false) {
+        return nullptr;
+    }
+    return m_vecValue.back();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SSAFunction
+SSAValue* SSAFunction::NewValue(ESSAOpcode _eOpcode, SSABlock* _pBlock)
+{
+    auto pValue = std::make_unique<SSAValue>();
+    pValue->m_iId = m_vecValue.size();
+    pValue->m_eOpcode = _eOpcode;
+    pValue->m_pBlock = _pBlock;
+    m_vecValue.push_back(std::move(pValue));
+    return m_vecValue.back().get();
+}
+
+SSABlock* SSAFunction::NewBlock()
+{
+    auto pBlock = std::make_unique<SSABlock>();
+    pBlock->m_iId = m_vecBlock.empty() ? 0 : m_vecBlock.back()->m_iId + 1;
+    m_vecBlock.push_back(std::move(pBlock));
+    return m_vecBlock.back().get();
+}
+
+void SSAFunction::AddOperand(SSAValue* _pValue, SSAValue* _pOperand)
+{
+    _pValue->m_vecOperand.push_back(_pOperand);
+    _pOperand->m_vecUser.push_back(_pValue);
+}
+
+void SSAFunction::ReplaceAllUses(SSAValue* _pValue, SSAValue* _pReplace)
+{
+    // m_vecUser holds one entry per operand slot, so each entry rewrites exactly one slot
+    auto vecUser = std::move(_pValue->m_vecUser);
+    _pValue->m_vecUser.clear();
+    for (SSAValue* pUser : vecUser) {
+        auto findIt = std::find(pUser->m_vecOperand.begin(), pUser->m_vecOperand.end(), _pValue);
+        *findIt = _pReplace;
+        _pReplace->m_vecUser.push_back(pUser);
+    }
+    _pValue->m_pReplace = _pReplace;
+}
+
+void SSAFunction::RemoveValue(SSAValue* _pValue)
+{
+    for (SSAValue* pOperand : _pValue->m_vecOperand) {
+        EraseOne(pOperand->m_vecUser, _pValue);
+    }
+    _pValue->m_vecOperand.clear();
+    auto& vecList = _pValue->m_eOpcode == ESSAOpcode::Phi ? _pValue->m_pBlock->m_vecPhi : _pValue->m_pBlock->m_vecValue;
+    EraseOne(vecList, _pValue);
+    _pValue->m_bRemoved = true;
+}
+
+void SSAFunction::AddEdge(SSABlock* _pFrom, SSABlock* _pTo)
+{
+    _pFrom->m_vecSuccessor.push_back(_pTo);
+    _pTo->m_vecPredecessor.push_back(_pFrom);
+}
+
+void SSAFunction::RemoveEdge(SSABlock* _pFrom, SSABlock* _pTo)
+{
+    EraseOne(_pFrom->m_vecSuccessor, _pTo);
+    auto findIt = std::find(_pTo->m_vecPredecessor.begin(), _pTo->m_vecPredecessor.end(), _pFrom);
+    uint64 index = findIt - _pTo->m_vecPredecessor.begin();
+    _pTo->m_vecPredecessor.erase(findIt);
+    for (SSAValue* pPhi : _pTo->m_vecPhi) {
+        if (index < pPhi->m_vecOperand.size()) {
+            EraseOne(pPhi->m_vecOperand[index]->m_vecUser, pPhi);
+            pPhi->m_vecOperand.erase(pPhi->m_vecOperand.begin() + index);
+        }
+    }
+}
+
+void SSAFunction::RemoveUnreachableBlocks()
+{
+    std::set<SSABlock*> setReachable;
+    std::vector<SSABlock*> vecStack = { m_pEntry };
+    while (vecStack.empty() == false) {
+        SSABlock* pBlock = vecStack.back();
+        vecStack.pop_back();
+        if (setReachable.insert(pBlock).second) {
+            vecStack.insert(vecStack.end(), pBlock->m_vecSuccessor.begin(), pBlock->m_vecSuccessor.end());
+        }
+    }
+
+    std::vector<SSABlock*> vecUnreachable;
+    for (auto& pBlock : m_vecBlock) {
+        if (setReachable.count(pBlock.get()) == 0) {
+            vecUnreachable.push_back(pBlock.get());
+        }
+    }
+    for (SSABlock* pBlock : vecUnreachable) {
+        while (pBlock->m_vecSuccessor.empty() == false) {
+            RemoveEdge(pBlock, pBlock->m_vecSuccessor.front());
+        }
+    }
+    // Only other unreachable values and the phi operands dropped above can use these
+    for (SSABlock* pBlock : vecUnreachable) {
+        for (SSAValue* pValue : pBlock->m_vecPhi) {
+            for (SSAValue* pOperand : pValue->m_vecOperand) {
+                EraseOne(pOperand->m_vecUser, pValue);
+            }
+            pValue->m_bRemoved = true;
+        }
+        for (SSAValue* pValue : pBlock->m_vecValue) {
+            for (SSAValue* pOperand : pValue->m_vecOperand) {
+                EraseOne(pOperand->m_vecUser, pValue);
+            }
+            pValue->m_bRemoved = true;
+        }
+    }
+    std::erase_if(m_vecBlock, [&setReachable](std::unique_ptr<SSABlock>& _pBlock) {
+        return setReachable.count(_pBlock.get()) == 0;
+    });
+}
+
+std::vector<SSABlock*> SSAFunction::ReversePostOrder()
+{
+    // Successor 0 is visited last so it lands right after its block, which makes Branch fall through
+    std::vector<SSABlock*> vecResult;
+    std::set<SSABlock*> setVisited = { m_pEntry };
+    std::vector<std::pair<SSABlock*, uint64>> vecStack = { { m_pEntry, m_pEntry->m_vecSuccessor.size() } };
+    while (vecStack.empty() == false) {
+        auto& [pBlock, next] = vecStack.back();
+        if (next == 0) {
+            vecResult.push_back(pBlock);
+            vecStack.pop_back();
+            continue;
+        }
+        SSABlock* pSuccessor = pBlock->m_vecSuccessor[--next];
+        if (setVisited.insert(pSuccessor).second) {
+            vecStack.push_back({ pSuccessor, pSuccessor->m_vecSuccessor.size() });
+        }
+    }
+    std::reverse(vecResult.begin(), vecResult.end());
+    return vecResult;
+}
+
+void SSAFunction::ComputeDominator()
+{
+    // Cooper, Harvey and Kennedy's iterative algorithm over reverse post order
+    std::vector<SSABlock*> vecOrder = ReversePostOrder();
+    std::map<SSABlock*, uint64> mapIndex;
+    for (uint64 i = 0; i < vecOrder.size(); ++i) {
+        mapIndex[vecOrder[i]] = i;
+        vecOrder[i]->m_pDominator = nullptr;
+    }
+    auto intersect = [&mapIndex](SSABlock* _pLhs, SSABlock* _pRhs) {
+        while (_pLhs != _pRhs) {
+            while (mapIndex[_pLhs] > mapIndex[_pRhs]) {
+                _pLhs = _pLhs->m_pDominator;
+            }
+            while (mapIndex[_pRhs] > mapIndex[_pLhs]) {
+                _pRhs = _pRhs->m_pDominator;
+            }
+        }
+        return _pLhs;
+    };
+
+    m_pEntry->m_pDominator = m_pEntry;
+    bool bChanged = true;
+    while (bChanged) {
+        bChanged = false;
+        for (uint64 i = 1; i < vecOrder.size(); ++i) {
+            SSABlock* pDominator = nullptr;
+            for (SSABlock* pPredecessor : vecOrder[i]->m_vecPredecessor) {
+                if (pPredecessor->m_pDominator == nullptr) {
+                    continue;
+                }
+                pDominator = pDominator ? intersect(pPredecessor, pDominator) : pPredecessor;
+            }
+            if (vecOrder[i]->m_pDominator != pDominator) {
+                vecOrder[i]->m_pDominator = pDominator;
+                bChanged = true;
+            }
+        }
+    }
+    m_pEntry->m_pDominator = nullptr;
+}
+
+bool SSAFunction::Dominates(SSABlock* _pDominator, SSABlock* _pBlock)
+{
+    for (; _pBlock; _pBlock = _pBlock->m_pDominator) {
+        if (_pBlock == _pDominator) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string SSAFunction::PrintInfo()
+{
+    auto valueName = [](SSAValue* _pValue) {
+        if (_pValue->m_eOpcode == ESSAOpcode::Constant) {
+            return AnyToString(_pValue->m_anyConstant);
+        }
+        return "v" + std::to_string(_pValue->m_iId);
+    };
+
+    std::string strResult = "SSA " + m_strName + " :\n";
+    for (SSABlock* pBlock : ReversePostOrder()) {
+        strResult += "  block" + std::to_string(pBlock->m_iId) + " <-";
+        for (SSABlock* pPredecessor : pBlock->m_vecPredecessor) {
+            strResult += " block" + std::to_string(pPredecessor->m_iId);
+        }
+        strResult += "\n";
+        std::vector<SSAValue*> vecValue = pBlock->m_vecPhi;
+        vecValue.insert(vecValue.end(), pBlock->m_vecValue.begin(), pBlock->m_vecValue.end());
+        for (SSAValue* pValue : vecValue) {
+            if (pValue->m_eOpcode == ESSAOpcode::Constant) {
+                continue;
+            }
+            strResult += "    ";
+            if (pValue->HasResult()) {
+                strResult += valueName(pValue) + " = ";
+            }
+            strResult += ToString(pValue->m_eOpcode);
+            if (pValue->m_eOpcode == ESSAOpcode::Binary) {
+                strResult += " " + std::to_string(static_cast<uint64>(pValue->m_eOperator));
+            }
+            if (pValue->m_strName.empty() == false) {
+                strResult += " " + pValue->m_strName;
+            }
+            for (SSAValue* pOperand : pValue->m_vecOperand) {
+                strResult += " " + valueName(pOperand);
+            }
+            for (SSABlock* pSuccessor : pValue->IsTerminator() ? pBlock->m_vecSuccessor : std::vector<SSABlock*>()) {
+                strResult += " block" + std::to_string(pSuccessor->m_iId);
+            }
+            strResult += "\n";
+        }
+    }
+    return strResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SSAGenerater
+bool SSAGenerater::Generate(std::shared_ptr<Function> _pFunction)
+{
+    auto pFunction = Build(_pFunction);
+    if (pFunction == nullptr) {
+        return false;
+    }
+    SSAPassMgr.Optimize(*pFunction);
+    Lower(*pFunction);
+    return true;
+}
+
+std::unique_ptr<SSAFunction> SSAGenerater::Build(std::shared_ptr<Function> _pFunction)
+{
+    auto pResult = std::make_unique<SSAFunction>();
+    pResult->m_strName = _pFunction->m_strName;
+    pResult->m_iParameterCount = _pFunction->m_vecParameter.size();
+
+    m_pFunction = pResult.get();
+    m_bSupported = true;
+    m_iVariableCount = 0;
+    m_listScope.clear();
+    m_mapCurrentDef.clear();
+    m_vecBreakTarget.clear();
+    m_vecContinueTarget.clear();
+
+    pResult->m_pEntry = NewBlock();
+    SealBlock(pResult->m_pEntry);
+    SetBlock(pResult->m_pEntry);
+    PushScope();
+    for (uint64 i = 0; i < _pFunction->m_vecParameter.size(); ++i) {
+        DeclareVariable(_pFunction->m_vecParameter[i]);
+        SSAValue* pParameter = Emit(ESSAOpcode::Parameter);
+        pParameter->m_iCount = i;
+        WriteVariable(FindVariable(_pFunction->m_vecParameter[i]), pParameter);
+    }
+    _pFunction->BuildSSA();
+    EmitReturn(EmitConstant(nullptr));
+    PopScope();
+    m_pFunction = nullptr;
+    m_pBlock = nullptr;
+
+    if (m_bSupported == false) {
+        return nullptr;
+    }
+    pResult->RemoveUnreachableBlocks();
+    return pResult;
+}
+
+void SSAGenerater::Lower(SSAFunction& _function)
+{
+    // Split critical edges so phi copies always sit at the end of a block with a single successor
+    std::vector<SSABlock*> vecBlock;
+    for (auto& pBlock : _function.m_vecBlock) {
+        vecBlock.push_back(pBlock.get());
+    }
+    for (SSABlock* pBlock : vecBlock) {
+        if (pBlock->m_vecSuccessor.size() < 2) {
+            continue;
+        }
+        for (auto& pSuccessor : pBlock->m_vecSuccessor) {
+            if (pSuccessor->m_vecPredecessor.size() < 2 || pSuccessor->m_vecPhi.empty()) {
+                continue;
+            }
+            SSABlock* pEdge = _function.NewBlock();
+            *std::find(pSuccessor->m_vecPredecessor.begin(), pSuccessor->m_vecPredecessor.end(), pBlock) = pEdge;
+            pEdge->m_vecPredecessor.push_back(pBlock);
+            pEdge->m_vecSuccessor.push_back(pSuccessor);
+            pEdge->m_vecValue.push_back(_function.NewValue(ESSAOpcode::Jump, pEdge));
+            pSuccessor = pEdge;
+        }
+    }
+
+    _function.ComputeDominator();
+
+    // Slots : parameters keep 0..n-1, every other value that outlives its single use gets its own slot
+    std::vector<SSABlock*> vecOrder = _function.ReversePostOrder();
+    uint64 slotCount = _function.m_iParameterCount;
+    for (SSABlock* pBlock : vecOrder) {
+        MarkInline(pBlock);
+        for (SSAValue* pPhi : pBlock->m_vecPhi) {
+            pPhi->m_iSlot = slotCount++;
+        }
+        for (SSAValue* pValue : pBlock->m_vecValue) {
+            if (pValue->m_eOpcode == ESSAOpcode::Parameter) {
+                pValue->m_iSlot = pValue->m_iCount;
+            }
+            else if (pValue->m_eOpcode == ESSAOpcode::Undefined) {
+                // Never written, reads the empty value Alloca leaves behind
+                pValue->m_iSlot = slotCount++;
+            }
+            else if (pValue->m_eOpcode != ESSAOpcode::Constant && pValue->HasResult() &&
+                pValue->m_bInline == false && pValue->m_vecUser.empty() == false) {
+                pValue->m_iSlot = slotCount++;
+            }
+        }
+    }
+
+    std::function<void(SSAValue*)> emitValue;
+    std::function<void(SSAValue*)> emitOperation = [&emitValue](SSAValue* _pValue) {
+        // A builtin with its own instruction or linked to CallNative leaves the callee out
+        Instruction intrinsic;
+        uint64 native = 0;
+        bool bGlobal = _pValue->m_eOpcode == ESSAOpcode::Call && _pValue->m_vecOperand.back()->m_eOpcode == ESSAOpcode::GetGlobal;
+        bool bIntrinsic = bGlobal && GeneraterMgr.FindIntrinsic(_pValue->m_vecOperand.back()->m_strName, _pValue->m_iCount, intrinsic);
+        bool bNative = bGlobal && bIntrinsic == false && GeneraterMgr.FindNative(_pValue->m_vecOperand.back()->m_strName, _pValue->m_iCount, native);
+        for (uint64 i = 0; i < _pValue->m_vecOperand.size() - (bIntrinsic || bNative ? 1 : 0); ++i) {
+            emitValue(_pValue->m_vecOperand[i]);
+        }
+        switch (_pValue->m_eOpcode) {
+        case ESSAOpcode::Binary:        GeneraterMgr.WriteCode(TypeInference::ToTypedInstruction(ToInstruction(_pValue->m_eOperator), 
+                                            _pValue->m_vecOperand[0]->m_iType, _pValue->m_vecOperand[1]->m_iType)); break;
+        case ESSAOpcode::Absolute:      GeneraterMgr.WriteCode(Instruction::Absolute); break;
+        case ESSAOpcode::ReverseSign:   GeneraterMgr.WriteCode(Instruction::ReverseSign); break;
+        case ESSAOpcode::GetGlobal:     GeneraterMgr.WriteCode(Instruction::GetGlobal, _pValue->m_strName); break;
+        case ESSAOpcode::SetGlobal:     GeneraterMgr.WriteCode(Instruction::SetGlobal, _pValue->m_strName); break;
+        case ESSAOpcode::GetElement:    GeneraterMgr.WriteCode(TypeInference::ToTypedInstruction(Instruction::GetElement, 
+                                            _pValue->m_vecOperand[0]->m_iType, _pValue->m_vecOperand[1]->m_iType)); break;
+        case ESSAOpcode::SetElement:    GeneraterMgr.WriteCode(TypeInference::ToTypedInstruction(Instruction::SetElement, 
+                                            _pValue->m_vecOperand[1]->m_iType, _pValue->m_vecOperand[2]->m_iType)); break;
+        case ESSAOpcode::Call:
+            if (bIntrinsic) {
+                GeneraterMgr.WriteCode(intrinsic);
+            }
+            else if (bNative) {
+                GeneraterMgr.WriteCode(Instruction::CallNative, native);
+            }
+            else {
+                GeneraterMgr.WriteCode(Instruction::Call, _pValue->m_iCount);
+            }
+            break;
+        case ESSAOpcode::MakeArray:     GeneraterMgr.WriteCode(_pValue->m_bScoped ? Instruction::PushScopedArray : Instruction::PushArray, _pValue->m_iCount); break;
+        case ESSAOpcode::MakeMap:       GeneraterMgr.WriteCode(_pValue->m_bScoped ? Instruction::PushScopedMap : Instruction::PushMap, _pValue->m_iCount); break;
+        case ESSAOpcode::Print:         GeneraterMgr.WriteCode(Instruction::Print, _pValue->m_iCount); break;
+        case ESSAOpcode::PrintLine:     GeneraterMgr.WriteCode(Instruction::PrintLine); break;
+        default: break;
+        }
+    };
+    emitValue = [&emitOperation](SSAValue* _pValue) {
+        if (_pValue->m_eOpcode == ESSAOpcode::Constant) {
+            const std::any& value = _pValue->m_anyConstant;
+            if (Object::IsNull(value)) {
+                GeneraterMgr.WriteCode(Instruction::PushNull);
+            }
+            else if (Object::IsBoolean(value)) {
+                GeneraterMgr.WriteCode(Instruction::PushBoolean, value);
+            }
+            else if (Object::IsString(value)) {
+                GeneraterMgr.WriteCode(Instruction::PushString, value);
+            }
+            else {
+                GeneraterMgr.WriteCode(Instruction::PushNumber, value);
+            }
+        }
+        else if (_pValue->m_bInline) {
+            emitOperation(_pValue);
+        }
+        else {
+            GeneraterMgr.WriteCode(Instruction::GetLocal, _pValue->m_iSlot);
+        }
+    };
+
+    GeneraterMgr.m_mapFunctionTable[_function.m_strName] = GeneraterMgr.m_vecCodeList.size();
+    uint64 alloca = GeneraterMgr.WriteCode(Instruction::Alloca);
+    std::vector<std::pair<uint64, SSABlock*>> vecPatch;
+    auto emitBody = [&emitOperation](SSABlock* _pBlock) {
+        for (SSAValue* pValue : _pBlock->m_vecValue) {
+            if (pValue->IsTerminator() || pValue->m_bInline ||
+                pValue->m_eOpcode == ESSAOpcode::Constant ||
+                pValue->m_eOpcode == ESSAOpcode::Parameter ||
+                pValue->m_eOpcode == ESSAOpcode::Undefined) {
+                continue;
+            }
+            emitOperation(pValue);
+            if (pValue->HasResult() == false) {
+                continue;
+            }
+            if (pValue->m_iSlot != SIZE_MAX) {
+                GeneraterMgr.WriteCode(Instruction::SetLocal, pValue->m_iSlot);
+            }
+            GeneraterMgr.WriteCode(Instruction::PopOperand);
+        }
+    };
+    // Loop inversion : a back edge into a small header that ends in Branch runs a copy of the header
+    // and tests at the bottom, so each iteration saves the Jump back to the top
+    auto isInvertible = [&_function](SSABlock* _pBlock, SSABlock* _pTarget) {
+        return _function.Dominates(_pTarget, _pBlock) && _pTarget->Terminator()->m_eOpcode == ESSAOpcode::Branch &&
+            _pTarget->m_vecValue.size() <= 16;
+    };
+
+    for (SSABlock* pBlock : vecOrder) {
+        pBlock->m_iAddress = GeneraterMgr.m_vecCodeList.size();
+        emitBody(pBlock);
+
+        SSAValue* pTerminator = pBlock->Terminator();
+        switch (pTerminator->m_eOpcode) {
+        case ESSAOpcode::Jump:
+            {
+                // Phi copies in parallel through the operand stack
+                SSABlock* pTarget = pBlock->m_vecSuccessor.front();
+                uint64 index = std::find(pTarget->m_vecPredecessor.begin(), pTarget->m_vecPredecessor.end(), pBlock) - pTarget->m_vecPredecessor.begin();
+                std::vector<SSAValue*> vecCopy;
+                for (SSAValue* pPhi : pTarget->m_vecPhi) {
+                    if (pPhi->m_vecOperand[index] != pPhi) {
+                        emitValue(pPhi->m_vecOperand[index]);
+                        vecCopy.push_back(pPhi);
+                    }
+                }
+                for (uint64 i = vecCopy.size(); i > 0; --i) {
+                    GeneraterMgr.WriteCode(Instruction::SetLocal, vecCopy[i - 1]->m_iSlot);
+                    GeneraterMgr.WriteCode(Instruction::PopOperand);
+                }
+                if (isInvertible(pBlock, pTarget) == false) {
+                    vecPatch.push_back({ GeneraterMgr.WriteCode(Instruction::Jump), pTarget });
+                    break;
+                }
+                emitBody(pTarget);
+                emitValue(pTarget->Terminator()->m_vecOperand.front());
+                vecPatch.push_back({ GeneraterMgr.WriteCode(Instruction::LoopJump), pTarget->m_vecSuccessor[0] });
+                vecPatch.push_back({ GeneraterMgr.WriteCode(Instruction::Jump), pTarget->m_vecSuccessor[1] });
+            }
+            break;
+        case ESSAOpcode::Branch:
+            emitValue(pTerminator->m_vecOperand.front());
+            vecPatch.push_back({ GeneraterMgr.WriteCode(Instruction::ConditionJump), pBlock->m_vecSuccessor[1] });
+            vecPatch.push_back({ GeneraterMgr.WriteCode(Instruction::Jump), pBlock->m_vecSuccessor[0] });
+            break;
+        case ESSAOpcode::BranchFalse:
+            {
+                // LogicalAnd keeps the value when it jumps, the landing pad drops it
+                emitValue(pTerminator->m_vecOperand.front());
+                uint64 logicalAnd = GeneraterMgr.WriteCode(Instruction::LogicalAnd);
+                vecPatch.push_back({ GeneraterMgr.WriteCode(Instruction::Jump), pBlock->m_vecSuccessor[1] });
+                GeneraterMgr.PatchAddress(logicalAnd);
+                GeneraterMgr.WriteCode(Instruction::PopOperand);
+                vecPatch.push_back({ GeneraterMgr.WriteCode(Instruction::Jump), pBlock->m_vecSuccessor[0] });
+            }
+            break;
+        case ESSAOpcode::Return:
+            emitValue(pTerminator->m_vecOperand.front());
+            // Same tail call as Return::Generate when the call is evaluated right here
+            if (pTerminator->m_vecOperand.front()->m_eOpcode == ESSAOpcode::Call && pTerminator->m_vecOperand.front()->m_bInline &&
+                GeneraterMgr.m_vecCodeList.back().m_instruction == Instruction::Call) {
+                GeneraterMgr.m_vecCodeList.back().m_instruction = Instruction::TailCall;
+            }
+            GeneraterMgr.WriteCode(Instruction::Return);
+            break;
+        default:
+            break;
+        }
+    }
+    for (auto& [codeIndex, pBlock] : vecPatch) {
+        GeneraterMgr.PatchOperand(codeIndex, pBlock->m_iAddress);
+    }
+    GeneraterMgr.PatchOperand(alloca, slotCount - _function.m_iParameterCount);
+}
+
+void SSAGenerater::MarkInline(SSABlock* _pBlock)
+{
+    auto& vecValue = _pBlock->m_vecValue;
+    std::map<SSAValue*, uint64> mapPosition;
+    for (uint64 i = 0; i < vecValue.size(); ++i) {
+        mapPosition[vecValue[i]] = i;
+    }
+    auto isSingleUse = [_pBlock](SSAValue* _pValue) {
+        return _pValue->m_vecUser.size() == 1 && _pValue->m_vecUser.front()->m_pBlock == _pBlock &&
+            _pValue->m_vecUser.front()->m_eOpcode != ESSAOpcode::Phi;
+    };
+
+    // Evaluated where it is used when nothing in between can observe the move,
+    // pure values feeding a phi of the only successor are evaluated inside the phi copy
+    std::unordered_set<SSAValue*> setEffect;
+    for (uint64 i = 0; i < vecValue.size(); ++i) {
+        SSAValue* pValue = vecValue[i];
+        if (pValue->HasResult() == false || pValue->m_eOpcode == ESSAOpcode::Constant ||
+            pValue->m_eOpcode == ESSAOpcode::Parameter || pValue->m_eOpcode == ESSAOpcode::Undefined) {
+            continue;
+        }
+        bool bEffect = pValue->HasSideEffect() || pValue->ReadsMemory();
+        for (SSAValue* pOperand : pValue->m_vecOperand) {
+            bEffect = bEffect || (pOperand->m_bInline && setEffect.count(pOperand));
+        }
+        if (bEffect) {
+            setEffect.insert(pValue);
+        }
+        if (pValue->m_vecUser.size() != 1) {
+            continue;
+        }
+
+        SSAValue* pUser = pValue->m_vecUser.front();
+        if (isSingleUse(pValue)) {
+            pValue->m_bInline = true;
+            for (uint64 j = i + 1; bEffect && j < mapPosition[pUser]; ++j) {
+                if (vecValue[j]->HasSideEffect() || vecValue[j]->ReadsMemory()) {
+                    pValue->m_bInline = false;
+                    break;
+                }
+            }
+        }
+        else if (pUser->m_eOpcode == ESSAOpcode::Phi && bEffect == false &&
+            _pBlock->m_vecSuccessor.size() == 1 && _pBlock->m_vecSuccessor.front() == pUser->m_pBlock) {
+            pValue->m_bInline = true;
+        }
+    }
+
+    // An effect may still stay on the operand stack when everything effectful in between
+    // ends up inside the later operands of the same user, f(a) + f(b) keeps the tree order
+    for (uint64 i = vecValue.size(); i > 0; --i) {
+        SSAValue* pValue = vecValue[i - 1];
+        if (pValue->m_bInline || setEffect.count(pValue) == 0 || isSingleUse(pValue) == false) {
+            continue;
+        }
+        SSAValue* pUser = pValue->m_vecUser.front();
+        if (pUser->m_bInline && setEffect.count(pUser) == 0) {
+            continue;
+        }
+        auto operandIndex = [pUser](SSAValue* _pOperand) -> uint64 {
+            return std::find(pUser->m_vecOperand.begin(), pUser->m_vecOperand.end(), _pOperand) - pUser->m_vecOperand.begin();
+        };
+        uint64 index = operandIndex(pValue);
+        bool bInline = true;
+        for (uint64 j = i; bInline && j < mapPosition[pUser]; ++j) {
+            SSAValue* pBetween = vecValue[j];
+            if (pBetween->HasSideEffect() == false && pBetween->ReadsMemory() == false) {
+                continue;
+            }
+            while (pBetween->m_bInline && pBetween->m_vecUser.front() != pUser) {
+                pBetween = pBetween->m_vecUser.front();
+            }
+            bInline = pBetween->m_bInline && operandIndex(pBetween) > index;
+        }
+        pValue->m_bInline = bInline;
+    }
+}
+
+SSAValue* SSAGenerater::Emit(ESSAOpcode _eOpcode, std::vector<SSAValue*> _vecOperand)
+{
+    SSAValue* pValue = m_pFunction->NewValue(_eOpcode, m_pBlock);
+    for (SSAValue* pOperand : _vecOperand) {
+        m_pFunction->AddOperand(pValue, pOperand);
+    }
+    m_pBlock->m_vecValue.push_back(pValue);
+    return pValue;
+}
+
+SSAValue* SSAGenerater::EmitConstant(std::any _anyValue)
+{
+    SSAValue* pValue = Emit(ESSAOpcode::Constant);
+    pValue->m_anyConstant = _anyValue;
+    return pValue;
+}
+
+SSAValue* SSAGenerater::EmitPhi(std::vector<SSAValue*> _vecOperand)
+{
+    SSAValue* pValue = m_pFunction->NewValue(ESSAOpcode::Phi, m_pBlock);
+    for (SSAValue* pOperand : _vecOperand) {
+        m_pFunction->AddOperand(pValue, pOperand);
+    }
+    m_pBlock->m_vecPhi.push_back(pValue);
+    return pValue;
+}
+
+void SSAGenerater::EmitJump(SSABlock* _pTarget)
+{
+    Emit(ESSAOpcode::Jump);
+    m_pFunction->AddEdge(m_pBlock, _pTarget);
+}
+
+void SSAGenerater::EmitBranch(ESSAOpcode _eOpcode, SSAValue* _pCondition, SSABlock* _pTrue, SSABlock* _pFalse)
+{
+    Emit(_eOpcode, { _pCondition });
+    m_pFunction->AddEdge(m_pBlock, _pTrue);
+    m_pFunction->AddEdge(m_pBlock, _pFalse);
+}
+
+void SSAGenerater::EmitReturn(SSAValue* _pValue)
+{
+    Emit(ESSAOpcode::Return, { _pValue });
+}
+
+SSABlock* SSAGenerater::NewBlock()
+{
+    return m_pFunction->NewBlock();
+}
+
+void SSAGenerater::SetBlock(SSABlock* _pBlock)
+{
+    m_pBlock = _pBlock;
+}
+
+void SSAGenerater::SealBlock(SSABlock* _pBlock)
+{
+    for (auto& [variable, pPhi] : _pBlock->m_mapIncompletePhi) {
+        AddPhiOperands(variable, pPhi);
+    }
+    _pBlock->m_mapIncompletePhi.clear();
+    _pBlock->m_bSealed = true;
+}
+
+void SSAGenerater::BeginDeadBlock()
+{
+    SSABlock* pBlock = NewBlock();
+    SealBlock(pBlock);
+    SetBlock(pBlock);
+}
+
+void SSAGenerater::DeclareVariable(std::string _strName)
+{
+    m_listScope.front()[_strName] = m_iVariableCount++;
+}
+
+uint64 SSAGenerater::FindVariable(std::string _strName)
+{
+    for (auto& mapScope : m_listScope) {
+        auto findIt = mapScope.find(_strName);
+        if (findIt != mapScope.end()) {
+            return findIt->second;
+        }
+    }
+    return SIZE_MAX;
+}
+
+void SSAGenerater::WriteVariable(uint64 _iVariable, SSAValue* _pValue)
+{
+    WriteVariable(_iVariable, m_pBlock, _pValue);
+}
+
+SSAValue* SSAGenerater::ReadVariable(uint64 _iVariable)
+{
+    return ReadVariable(_iVariable, m_pBlock);
+}
+
+void SSAGenerater::PushScope()
+{
+    m_listScope.emplace_front();
+}
+
+void SSAGenerater::PopScope()
+{
+    m_listScope.pop_front();
+}
+
+void SSAGenerater::WriteVariable(uint64 _iVariable, SSABlock* _pBlock, SSAValue* _pValue)
+{
+    m_mapCurrentDef[_iVariable][_pBlock] = _pValue;
+}
+
+SSAValue* SSAGenerater::ReadVariable(uint64 _iVariable, SSABlock* _pBlock)
+{
+    auto& mapDef = m_mapCurrentDef[_iVariable];
+    auto findIt = mapDef.find(_pBlock);
+    if (findIt == mapDef.end()) {
+        return ReadVariableRecursive(_iVariable, _pBlock);
+    }
+    SSAValue* pValue = findIt->second;
+    while (pValue->m_pReplace) {
+        pValue = pValue->m_pReplace;
+    }
+    return pValue;
+}
+
+SSAValue* SSAGenerater::ReadVariableRecursive(uint64 _iVariable, SSABlock* _pBlock)
+{
+    SSAValue* pValue = nullptr;
+    if (_pBlock->m_bSealed == false) {
+        pValue = m_pFunction->NewValue(ESSAOpcode::Phi, _pBlock);
+        _pBlock->m_vecPhi.push_back(pValue);
+        _pBlock->m_mapIncompletePhi[_iVariable] = pValue;
+    }
+    else if (_pBlock->m_vecPredecessor.empty()) {
+        pValue = MakeUndefined();
+    }
+    else if (_pBlock->m_vecPredecessor.size() == 1) {
+        pValue = ReadVariable(_iVariable, _pBlock->m_vecPredecessor.front());
+    }
+    else {
+        // Written before the operands are read so loops find this phi instead of recursing forever
+        pValue = m_pFunction->NewValue(ESSAOpcode::Phi, _pBlock);
+        _pBlock->m_vecPhi.push_back(pValue);
+        WriteVariable(_iVariable, _pBlock, pValue);
+        pValue = AddPhiOperands(_iVariable, pValue);
+    }
+    WriteVariable(_iVariable, _pBlock, pValue);
+    return pValue;
+}
+
+SSAValue* SSAGenerater::AddPhiOperands(uint64 _iVariable, SSAValue* _pPhi)
+{
+    for (SSABlock* pPredecessor : _pPhi->m_pBlock->m_vecPredecessor) {
+        m_pFunction->AddOperand(_pPhi, ReadVariable(_iVariable, pPredecessor));
+    }
+    return TryRemoveTrivialPhi(_pPhi);
+}
+
+SSAValue* SSAGenerater::TryRemoveTrivialPhi(SSAValue* _pPhi)
+{
+    SSAValue* pSame = nullptr;
+    for (SSAValue* pOperand : _pPhi->m_vecOperand) {
+        if (pOperand == pSame || pOperand == _pPhi) {
+            continue;
+        }
+        if (pSame) {
+            return _pPhi;
+        }
+        pSame = pOperand;
+    }
+    if (pSame == nullptr) {
+        pSame = MakeUndefined();
+    }
+
+    std::vector<SSAValue*> vecUser;
+    for (SSAValue* pUser : _pPhi->m_vecUser) {
+        if (pUser != _pPhi) {
+            vecUser.push_back(pUser);
+        }
+    }
+    m_pFunction->ReplaceAllUses(_pPhi, pSame);
+    m_pFunction->RemoveValue(_pPhi);
+    for (SSAValue* pUser : vecUser) {
+        if (pUser->m_eOpcode == ESSAOpcode::Phi && pUser->m_bRemoved == false) {
+            TryRemoveTrivialPhi(pUser);
+        }
+    }
+    // A phi user removed above may have been the replacement itself
+    while (pSame->m_pReplace) {
+        pSame = pSame->m_pReplace;
+    }
+    return pSame;
+}
+
+SSAValue* SSAGenerater::MakeUndefined()
+{
+    // Kept at the top of the entry block so it dominates every read
+    SSAValue* pValue = m_pFunction->NewValue(ESSAOpcode::Undefined, m_pFunction->m_pEntry);
+    auto& vecValue = m_pFunction->m_pEntry->m_vecValue;
+    vecValue.insert(vecValue.begin(), pValue);
+    return pValue;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Function
+void Function::BuildSSA()
+{
+    for (auto& pNode : m_vecBlock) {
+        pNode->BuildSSA();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - For
+void For::BuildSSA()
+{
+    SSAMgr.PushScope();
+    m_pVariable->BuildSSA();
+    SSABlock* pHeader = SSAMgr.NewBlock();
+    SSABlock* pBody = SSAMgr.NewBlock();
+    SSABlock* pContinue = SSAMgr.NewBlock();
+    SSABlock* pExit = SSAMgr.NewBlock();
+    SSAMgr.EmitJump(pHeader);
+
+    // Sealed only after the back edge from the continue block exists
+    SSAMgr.SetBlock(pHeader);
+    SSAMgr.EmitBranch(ESSAOpcode::Branch, m_pCondition->BuildSSA(), pBody, pExit);
+
+    SSAMgr.SealBlock(pBody);
+    SSAMgr.SetBlock(pBody);
+    SSAMgr.m_vecBreakTarget.push_back(pExit);
+    SSAMgr.m_vecContinueTarget.push_back(pContinue);
+    for (auto& pNode : m_vecBlock) {
+        pNode->BuildSSA();
+    }
+    SSAMgr.m_vecBreakTarget.pop_back();
+    SSAMgr.m_vecContinueTarget.pop_back();
+    SSAMgr.EmitJump(pContinue);
+
+    SSAMgr.SealBlock(pContinue);
+    SSAMgr.SetBlock(pContinue);
+    m_pExpression->BuildSSA();
+    SSAMgr.EmitJump(pHeader);
+    SSAMgr.SealBlock(pHeader);
+
+    SSAMgr.SealBlock(pExit);
+    SSAMgr.SetBlock(pExit);
+    SSAMgr.PopScope();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - If
+void If::BuildSSA()
+{
+    SSABlock* pEnd = SSAMgr.NewBlock();
+    for (uint64 i = 0; i < m_vecCondition.size(); ++i) {
+        SSAValue* pCondition = m_vecCondition[i]->BuildSSA();
+        SSABlock* pThen = SSAMgr.NewBlock();
+        SSABlock* pElse = SSAMgr.NewBlock();
+        SSAMgr.EmitBranch(ESSAOpcode::Branch, pCondition, pThen, pElse);
+
+        SSAMgr.SealBlock(pThen);
+        SSAMgr.SetBlock(pThen);
+        SSAMgr.PushScope();
+        for (auto& pNode : m_vecBlocks[i]) {
+            pNode->BuildSSA();
+        }
+        SSAMgr.PopScope();
+        SSAMgr.EmitJump(pEnd);
+
+        SSAMgr.SealBlock(pElse);
+        SSAMgr.SetBlock(pElse);
+    }
+
+    SSAMgr.PushScope();
+    for (auto& pNode : m_vecElseBlock) {
+        pNode->BuildSSA();
+    }
+    SSAMgr.PopScope();
+    SSAMgr.EmitJump(pEnd);
+    SSAMgr.SealBlock(pEnd);
+    SSAMgr.SetBlock(pEnd);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Variable
+void Variable::BuildSSA()
+{
+    // Declared before the initializer like Generate, a self reference reads the undefined value
+    SSAMgr.DeclareVariable(m_strName);
+    uint64 variable = SSAMgr.FindVariable(m_strName);
+    SSAValue* pValue = m_pExpression ? m_pExpression->BuildSSA() : SSAMgr.EmitConstant(nullptr);
+    SSAMgr.WriteVariable(variable, pValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Print
+void Print::BuildSSA()
+{
+    std::vector<SSAValue*> vecOperand;
+    for (uint64 i = m_vecArgument.size(); i > 0; --i) {
+        vecOperand.push_back(m_vecArgument[i - 1]->BuildSSA());
+    }
+    SSAMgr.Emit(ESSAOpcode::Print, vecOperand)->m_iCount = m_vecArgument.size();
+    if (m_bLineFeed) {
+        SSAMgr.Emit(ESSAOpcode::PrintLine);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Return
+void Return::BuildSSA()
+{
+    SSAMgr.EmitReturn(m_pExpression->BuildSSA());
+    SSAMgr.BeginDeadBlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Break
+void Break::BuildSSA()
+{
+    if (SSAMgr.m_vecBreakTarget.empty()) {
+        return;
+    }
+    SSAMgr.EmitJump(SSAMgr.m_vecBreakTarget.back());
+    SSAMgr.BeginDeadBlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Continue
+void Continue::BuildSSA()
+{
+    if (SSAMgr.m_vecContinueTarget.empty()) {
+        return;
+    }
+    SSAMgr.EmitJump(SSAMgr.m_vecContinueTarget.back());
+    SSAMgr.BeginDeadBlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - ExpressionStatement
+void ExpressionStatement::BuildSSA()
+{
+    m_pExpression->BuildSSA();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Or
+SSAValue* Or::BuildSSA()
+{
+    SSAValue* pLhs = m_pLhs->BuildSSA();
+    SSABlock* pRhsBlock = SSAMgr.NewBlock();
+    SSABlock* pEnd = SSAMgr.NewBlock();
+    SSAMgr.EmitBranch(ESSAOpcode::Branch, pLhs, pEnd, pRhsBlock);
+
+    SSAMgr.SealBlock(pRhsBlock);
+    SSAMgr.SetBlock(pRhsBlock);
+    SSAValue* pRhs = m_pRhs->BuildSSA();
+    SSAMgr.EmitJump(pEnd);
+
+    SSAMgr.SealBlock(pEnd);
+    SSAMgr.SetBlock(pEnd);
+    return SSAMgr.EmitPhi({ pLhs, pRhs });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - And
+SSAValue* And::BuildSSA()
+{
+    SSAValue* pLhs = m_pLhs->BuildSSA();
+    SSABlock* pRhsBlock = SSAMgr.NewBlock();
+    SSABlock* pEnd = SSAMgr.NewBlock();
+    SSAMgr.EmitBranch(ESSAOpcode::BranchFalse, pLhs, pEnd, pRhsBlock);
+
+    SSAMgr.SealBlock(pRhsBlock);
+    SSAMgr.SetBlock(pRhsBlock);
+    SSAValue* pRhs = m_pRhs->BuildSSA();
+    SSAMgr.EmitJump(pEnd);
+
+    SSAMgr.SealBlock(pEnd);
+    SSAMgr.SetBlock(pEnd);
+    return SSAMgr.EmitPhi({ pLhs, pRhs });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Relational
+SSAValue* Relational::BuildSSA()
+{
+    SSAValue* pLhs = m_pLhs->BuildSSA();
+    SSAValue* pRhs = m_pRhs->BuildSSA();
+    SSAValue* pResult = SSAMgr.Emit(ESSAOpcode::Binary, { pLhs, pRhs });
+    pResult->m_eOperator = ToOperator(m_eKind);
+    return pResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Arithmetic
+SSAValue* Arithmetic::BuildSSA()
+{
+    SSAValue* pLhs = m_pLhs->BuildSSA();
+    SSAValue* pRhs = m_pRhs->BuildSSA();
+    SSAValue* pResult = SSAMgr.Emit(ESSAOpcode::Binary, { pLhs, pRhs });
+    pResult->m_eOperator = ToOperator(m_eKind);
+    return pResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Unary
+SSAValue* Unary::BuildSSA()
+{
+    SSAValue* pSub = m_pSub->BuildSSA();
+    return SSAMgr.Emit(m_eKind == EKind::Add ? ESSAOpcode::Absolute : ESSAOpcode::ReverseSign, { pSub });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Call
+SSAValue* Call::BuildSSA()
+{
+    std::vector<SSAValue*> vecOperand;
+    for (uint64 i = m_vecArgument.size(); i > 0; --i) {
+        vecOperand.push_back(m_vecArgument[i - 1]->BuildSSA());
+    }
+    vecOperand.push_back(m_pSub->BuildSSA());
+    SSAValue* pResult = SSAMgr.Emit(ESSAOpcode::Call, vecOperand);
+    pResult->m_iCount = m_vecArgument.size();
+    return pResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - GetElement
+SSAValue* GetElement::BuildSSA()
+{
+    SSAValue* pSub = m_pSub->BuildSSA();
+    SSAValue* pIndex = m_pIndex->BuildSSA();
+    return SSAMgr.Emit(ESSAOpcode::GetElement, { pSub, pIndex });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SetElement
+SSAValue* SetElement::BuildSSA()
+{
+    SSAValue* pValue = m_pValue->BuildSSA();
+    SSAValue* pSub = m_pSub->BuildSSA();
+    SSAValue* pIndex = m_pIndex->BuildSSA();
+    return SSAMgr.Emit(ESSAOpcode::SetElement, { pValue, pSub, pIndex });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - GetVariable
+SSAValue* GetVariable::BuildSSA()
+{
+    uint64 variable = SSAMgr.FindVariable(m_strName);
+    if (variable != SIZE_MAX) {
+        return SSAMgr.ReadVariable(variable);
+    }
+    SSAValue* pResult = SSAMgr.Emit(ESSAOpcode::GetGlobal);
+    pResult->m_strName = m_strName;
+    return pResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SetVariable
+SSAValue* SetVariable::BuildSSA()
+{
+    SSAValue* pValue = m_pValue->BuildSSA();
+    uint64 variable = SSAMgr.FindVariable(m_strName);
+    if (variable != SIZE_MAX) {
+        SSAMgr.WriteVariable(variable, pValue);
+        return pValue;
+    }
+    SSAValue* pResult = SSAMgr.Emit(ESSAOpcode::SetGlobal, { pValue });
+    pResult->m_strName = m_strName;
+    return pResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - NullLiteral
+SSAValue* NullLiteral::BuildSSA()
+{
+    return SSAMgr.EmitConstant(nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - BooleanLiteral
+SSAValue* BooleanLiteral::BuildSSA()
+{
+    return SSAMgr.EmitConstant(m_bValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - NumberLiteral
+SSAValue* NumberLiteral::BuildSSA()
+{
+    return SSAMgr.EmitConstant(m_uValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - FloatLiteral
+SSAValue* FloatLiteral::BuildSSA()
+{
+    return SSAMgr.EmitConstant(m_dValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - StringLiteral
+SSAValue* StringLiteral::BuildSSA()
+{
+    return SSAMgr.EmitConstant(m_strValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - ArrayLiteral
+SSAValue* ArrayLiteral::BuildSSA()
+{
+    std::vector<SSAValue*> vecOperand;
+    for (uint64 i = m_vecValue.size(); i > 0; --i) {
+        vecOperand.push_back(m_vecValue[i - 1]->BuildSSA());
+    }
+    SSAValue* pResult = SSAMgr.Emit(ESSAOpcode::MakeArray, vecOperand);
+    pResult->m_iCount = m_vecValue.size();
+    pResult->m_bScoped = EscapeMgr.IsScoped(this);
+    return pResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - MapLiteral
+SSAValue* MapLiteral::BuildSSA()
+{
+    std::vector<SSAValue*> vecOperand;
+    for (auto& [key, pValue] : m_mapValue) {
+        vecOperand.push_back(SSAMgr.EmitConstant(key));
+        vecOperand.push_back(pValue->BuildSSA());
+    }
+    SSAValue* pResult = SSAMgr.Emit(ESSAOpcode::MakeMap, vecOperand);
+    pResult->m_iCount = m_mapValue.size();
+    pResult->m_bScoped = EscapeMgr.IsScoped(this);
+    return pResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - Class
+void Class::BuildSSA()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - SetClassAccess
+SSAValue* SetClassAccess::BuildSSA()
+{
+    SSAMgr.m_bSupported = false;
+    return SSAMgr.EmitConstant(nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// - GetClassAccess
+SSAValue* GetClassAccess::BuildSSA()
+{
+    SSAMgr.m_bSupported = false;
+    return SSAMgr.EmitConstant(nullptr);
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <any>
+#include <map>
+#include <list>
+#include <vector>
+#include <string>
+#include <memory>
+#include "TypeDefine.h"
+#include "Operator.h"
+#include "Node.h"
+
+// Operand order of every opcode is the order the stack machine pushes them in
+enum class ESSAOpcode
+{
+	Undefined,
+	Constant,
+	Parameter,
+	Phi,
+	Binary,
+	Absolute,
+	ReverseSign,
+	GetGlobal,
+	SetGlobal,
+	GetElement,
+	SetElement,
+	Call,
+	MakeArray,
+	MakeMap,
+	Print,
+	PrintLine,
+
+	// Terminators, always the last value of a block
+	Jump,
+	Branch,			// IsTrue(operand) ? successor 0 : successor 1
+	BranchFalse,	// IsFalse(operand) ? successor 0 : successor 1
+	Return,
+};
+
+struct SSABlock;
+
+struct SSAValue
+{
+public:
+	bool IsTerminator() const;
+	// Writes memory, globals or the console, or calls out
+	bool HasSideEffect() const;
+	// Result depends on memory or globals
+	bool ReadsMemory() const;
+	bool HasResult() const;
+
+public:
+	uint64 m_iId = 0;
+	ESSAOpcode m_eOpcode = ESSAOpcode::Undefined;
+	EOperator m_eOperator = EOperator::Add;
+	std::any m_anyConstant;
+	std::string m_strName;
+	uint64 m_iCount = 0;
+	std::vector<SSAValue*> m_vecOperand;
+	std::vector<SSAValue*> m_vecUser;
+	SSABlock* m_pBlock = nullptr;
+	SSAValue* m_pReplace = nullptr;
+	bool m_bRemoved = false;
+	// Lowering
+	uint64 m_iSlot = SIZE_MAX;
+	bool m_bInline = false;
+	// MakeArray/MakeMap of a literal that never leaves the function
+	bool m_bScoped = false;
+	// TypeSet from SSAPass::InferType
+	uint16 m_iType = 0;
+};
+
+struct SSABlock
+{
+public:
+	SSAValue* Terminator() const;
+
+public:
+	uint64 m_iId = 0;
+	std::vector<SSAValue*> m_vecPhi;
+	std::vector<SSAValue*> m_vecValue;
+	std::vector<SSABlock*> m_vecPredecessor;
+	std::vector<SSABlock*> m_vecSuccessor;
+	bool m_bSealed = false;
+	bool m_bRemoved = false;
+	// Immediate dominator, nullptr for the entry block, valid after SSAFunction::ComputeDominator
+	SSABlock* m_pDominator = nullptr;
+	// Variable id -> incomplete phi, filled when the block gets sealed
+	std::map<uint64, SSAValue*> m_mapIncompletePhi;
+	// Lowering
+	uint64 m_iAddress = 0;
+};
+
+struct SSAFunction
+{
+public:
+	SSAValue* NewValue(ESSAOpcode _eOpcode, SSABlock* _pBlock);
+	SSABlock* NewBlock();
+
+	void AddOperand(SSAValue* _pValue, SSAValue* _pOperand);
+	void ReplaceAllUses(SSAValue* _pValue, SSAValue* _pReplace);
+	void RemoveValue(SSAValue* _pValue);
+	void AddEdge(SSABlock* _pFrom, SSABlock* _pTo);
+	void RemoveEdge(SSABlock* _pFrom, SSABlock* _pTo);
+	void RemoveUnreachableBlocks();
+	std::vector<SSABlock*> ReversePostOrder();
+	void ComputeDominator();
+	bool Dominates(SSABlock* _pDominator, SSABlock* _pBlock);
+	std::string PrintInfo();
+
+public:
+	std::string m_strName;
+	uint64 m_iParameterCount = 0;
+	SSABlock* m_pEntry = nullptr;
+	std::vector<std::unique_ptr<SSABlock>> m_vecBlock;
+	std::vector<std::unique_ptr<SSAValue>> m_vecValue;
+};
+
+// Builds SSA per Function with the Braun et al. on the fly construction,
+// optimizes it with SSAPass and lowers it back to stack code through Generater
+class SSAGenerater
+{
+private:
+	SSAGenerater() { }
+	~SSAGenerater() { }
+public:
+	static SSAGenerater& GetInstance()
+	{
+		static thread_local SSAGenerater instance;
+		return instance;
+	}
+#define SSAMgr		SSAGenerater::GetInstance()
+
+public:
+	// false when the function uses nodes the SSA form does not cover, Function::Generate is used instead
+	bool Generate(std::shared_ptr<Function> _pFunction);
+	std::unique_ptr<SSAFunction> Build(std::shared_ptr<Function> _pFunction);
+	void Lower(SSAFunction& _function);
+
+public:
+	// Used by the BuildSSA of each node
+	SSAValue* Emit(ESSAOpcode _eOpcode, std::vector<SSAValue*> _vecOperand = {});
+	SSAValue* EmitConstant(std::any _anyValue);
+	SSAValue* EmitPhi(std::vector<SSAValue*> _vecOperand);
+	void EmitJump(SSABlock* _pTarget);
+	void EmitBranch(ESSAOpcode _eOpcode, SSAValue* _pCondition, SSABlock* _pTrue, SSABlock* _pFalse);
+	void EmitReturn(SSAValue* _pValue);
+	SSABlock* NewBlock();
+	void SetBlock(SSABlock* _pBlock);
+	void SealBlock(SSABlock* _pBlock);
+	// Code after Return/Break/Continue goes into a block nothing jumps to
+	void BeginDeadBlock();
+
+	void DeclareVariable(std::string _strName);
+	uint64 FindVariable(std::string _strName);
+	void WriteVariable(uint64 _iVariable, SSAValue* _pValue);
+	SSAValue* ReadVariable(uint64 _iVariable);
+	void PushScope();
+	void PopScope();
+
+private:
+	void WriteVariable(uint64 _iVariable, SSABlock* _pBlock, SSAValue* _pValue);
+	SSAValue* ReadVariable(uint64 _iVariable, SSABlock* _pBlock);
+	SSAValue* ReadVariableRecursive(uint64 _iVariable, SSABlock* _pBlock);
+	SSAValue* AddPhiOperands(uint64 _iVariable, SSAValue* _pPhi);
+	SSAValue* TryRemoveTrivialPhi(SSAValue* _pPhi);
+	SSAValue* MakeUndefined();
+	// Values evaluated at their single use instead of going through a slot
+	void MarkInline(SSABlock* _pBlock);
+
+public:
+	SSAFunction* m_pFunction = nullptr;
+	SSABlock* m_pBlock = nullptr;
+	bool m_bSupported = true;
+	std::vector<SSABlock*> m_vecBreakTarget;
+	std::vector<SSABlock*> m_vecContinueTarget;
+
+private:
+	uint64 m_iVariableCount = 0;
+	std::list<std::map<std::string, uint64>> m_listScope;
+	// Variable id -> block -> current definition
+	std::map<uint64, std::map<SSABlock*, SSAValue*>> m_mapCurrentDef;
+};
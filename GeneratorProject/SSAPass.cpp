@@ -0,0 +1,559 @@
+#include <set>
+#include <algorithm>
+#include <cstring>
+#include "SSAPass.h"
+#include "Object.h"
+#include "TypeInference.h"
+#include "CallGraph.h"
+
+namespace
+{
+    struct Lattice
+    {
+    public:
+        enum class EState
+        {
+            Top,
+            Constant,
+            Bottom,
+        };
+
+    public:
+        EState m_eState = EState::Top;
+        std::any m_anyValue;
+    };
+
+    bool IsSameConstant(const std::any& _lhs, const std::any& _rhs)
+    {
+        if (_lhs.type() != _rhs.type()) {
+            return false;
+        }
+        if (Object::IsNull(_lhs)) {
+            return true;
+        }
+        if (Object::IsBoolean(_lhs)) {
+            return Object::ToBoolean(_lhs) == Object::ToBoolean(_rhs);
+        }
+        if (Object::IsNumber(_lhs)) {
+            return Object::ToNumber(_lhs) == Object::ToNumber(_rhs);
+        }
+        if (Object::IsFloat(_lhs)) {
+            return Object::ToFloat(_lhs) == Object::ToFloat(_rhs);
+        }
+        if (Object::IsString(_lhs)) {
+            return Object::ToString(_lhs) == Object::ToString(_rhs);
+        }
+        return false;
+    }
+
+    Lattice Meet(const Lattice& _lhs, const Lattice& _rhs)
+    {
+        if (_lhs.m_eState == Lattice::EState::Top) {
+            return _rhs;
+        }
+        if (_rhs.m_eState == Lattice::EState::Top) {
+            return _lhs;
+        }
+        if (_lhs.m_eState == Lattice::EState::Bottom || _rhs.m_eState == Lattice::EState::Bottom ||
+            IsSameConstant(_lhs.m_anyValue, _rhs.m_anyValue) == false) {
+            return { Lattice::EState::Bottom };
+        }
+        return _lhs;
+    }
+
+    std::string ToKey(SSAValue* _pValue)
+    {
+        if (_pValue->m_eOpcode != ESSAOpcode::Constant) {
+            return "v" + std::to_string(_pValue->m_iId);
+        }
+        const std::any& value = _pValue->m_anyConstant;
+        if (Object::IsBoolean(value)) {
+            return Object::ToBoolean(value) ? "true" : "false";
+        }
+        if (Object::IsNumber(value)) {
+            return "n" + std::to_string(Object::ToNumber(value));
+        }
+        if (Object::IsFloat(value)) {
+            float64 number = Object::ToFloat(value);
+            uint64 bits = 0;
+            memcpy(&bits, &number, sizeof(bits));
+            return "f" + std::to_string(bits);
+        }
+        if (Object::IsString(value)) {
+            return "s" + std::to_string(Object::ToString(value).size()) + ":" + Object::ToString(value);
+        }
+        return "null";
+    }
+
+    // Same key, same result as long as memory did not change in between
+    std::string ToExpressionKey(SSAValue* _pValue)
+    {
+        std::string strKey = std::to_string(static_cast<uint64>(_pValue->m_eOpcode)) + ":" +
+            std::to_string(static_cast<uint64>(_pValue->m_eOperator)) + ":" +
+            std::to_string(_pValue->m_iCount) + ":" + _pValue->m_strName;
+        if (_pValue->m_eOpcode == ESSAOpcode::Phi) {
+            strKey += ":b" + std::to_string(_pValue->m_pBlock->m_iId);
+        }
+        for (SSAValue* pOperand : _pValue->m_vecOperand) {
+            strKey += "," + ToKey(pOperand);
+        }
+        return strKey;
+    }
+}
+
+void SSAPass::Optimize(SSAFunction& _function)
+{
+    PropagateConstant(_function);
+    PropagateCopy(_function);
+    NumberValue(_function);
+    HoistInvariant(_function);
+    EliminateDeadCode(_function);
+    InferType(_function);
+}
+
+void SSAPass::PropagateConstant(SSAFunction& _function)
+{
+    std::map<SSAValue*, Lattice> mapLattice;
+    std::set<SSABlock*> setExecutable;
+    std::set<std::pair<SSABlock*, SSABlock*>> setEdge;
+    std::vector<std::pair<SSABlock*, SSABlock*>> vecFlowWork = { { nullptr, _function.m_pEntry } };
+    std::vector<SSAValue*> vecValueWork;
+
+    auto evaluate = [&](SSAValue* _pValue) -> Lattice {
+        switch (_pValue->m_eOpcode) {
+        case ESSAOpcode::Constant:
+            return { Lattice::EState::Constant, _pValue->m_anyConstant };
+        case ESSAOpcode::Phi:
+            {
+                Lattice result;
+                auto& vecPredecessor = _pValue->m_pBlock->m_vecPredecessor;
+                for (uint64 i = 0; i < _pValue->m_vecOperand.size(); ++i) {
+                    if (setEdge.count({ vecPredecessor[i], _pValue->m_pBlock })) {
+                        result = Meet(result, mapLattice[_pValue->m_vecOperand[i]]);
+                    }
+                }
+                return result;
+            }
+        case ESSAOpcode::Binary:
+        case ESSAOpcode::Absolute:
+        case ESSAOpcode::ReverseSign:
+            {
+                std::vector<std::any> vecOperand;
+                for (SSAValue* pOperand : _pValue->m_vecOperand) {
+                    Lattice& operand = mapLattice[pOperand];
+                    if (operand.m_eState != Lattice::EState::Constant) {
+                        return { operand.m_eState };
+                    }
+                    vecOperand.push_back(operand.m_anyValue);
+                }
+                if (_pValue->m_eOpcode == ESSAOpcode::Binary) {
+                    return { Lattice::EState::Constant, Operate(_pValue->m_eOperator, vecOperand[0], vecOperand[1]) };
+                }
+                if (Object::IsNumber(vecOperand[0]) == false) {
+                    return { Lattice::EState::Constant, 0.0 };
+                }
+                if (_pValue->m_eOpcode == ESSAOpcode::Absolute) {
+                    return { Lattice::EState::Constant, Object::ToNumber(vecOperand[0]) };
+                }
+                return { Lattice::EState::Constant, Object::ToNumber(vecOperand[0]) * -1 };
+            }
+        default:
+            return { Lattice::EState::Bottom };
+        }
+    };
+
+    auto visit = [&](SSAValue* _pValue) {
+        SSABlock* pBlock = _pValue->m_pBlock;
+        switch (_pValue->m_eOpcode) {
+        case ESSAOpcode::Jump:
+            vecFlowWork.push_back({ pBlock, pBlock->m_vecSuccessor[0] });
+            return;
+        case ESSAOpcode::Branch:
+        case ESSAOpcode::BranchFalse:
+            {
+                Lattice& condition = mapLattice[_pValue->m_vecOperand.front()];
+                if (condition.m_eState == Lattice::EState::Bottom) {
+                    vecFlowWork.push_back({ pBlock, pBlock->m_vecSuccessor[0] });
+                    vecFlowWork.push_back({ pBlock, pBlock->m_vecSuccessor[1] });
+                }
+                else if (condition.m_eState == Lattice::EState::Constant) {
+                    bool bTaken = _pValue->m_eOpcode == ESSAOpcode::Branch ?
+                        Object::IsTrue(condition.m_anyValue) : Object::IsFalse(condition.m_anyValue);
+                    vecFlowWork.push_back({ pBlock, pBlock->m_vecSuccessor[bTaken ? 0 : 1] });
+                }
+            }
+            return;
+        case ESSAOpcode::Return:
+            return;
+        default:
+            break;
+        }
+
+        Lattice& current = mapLattice[_pValue];
+        Lattice result = evaluate(_pValue);
+        if (current.m_eState == Lattice::EState::Constant && result.m_eState == Lattice::EState::Constant &&
+            IsSameConstant(current.m_anyValue, result.m_anyValue) == false) {
+            result = { Lattice::EState::Bottom };
+        }
+        if (result.m_eState == current.m_eState) {
+            return;
+        }
+        current = result;
+        vecValueWork.insert(vecValueWork.end(), _pValue->m_vecUser.begin(), _pValue->m_vecUser.end());
+    };
+
+    while (vecFlowWork.empty() == false || vecValueWork.empty() == false) {
+        while (vecFlowWork.empty() == false) {
+            auto [pFrom, pTo] = vecFlowWork.back();
+            vecFlowWork.pop_back();
+            if (pFrom && setEdge.insert({ pFrom, pTo }).second == false) {
+                continue;
+            }
+            for (SSAValue* pPhi : pTo->m_vecPhi) {
+                visit(pPhi);
+            }
+            if (setExecutable.insert(pTo).second) {
+                for (SSAValue* pValue : pTo->m_vecValue) {
+                    visit(pValue);
+                }
+            }
+        }
+        while (vecValueWork.empty() == false) {
+            SSAValue* pValue = vecValueWork.back();
+            vecValueWork.pop_back();
+            if (pValue->m_bRemoved == false && setExecutable.count(pValue->m_pBlock)) {
+                visit(pValue);
+            }
+        }
+    }
+
+    // Values proven constant become constants in place
+    for (auto& [pValue, lattice] : mapLattice) {
+        if (lattice.m_eState != Lattice::EState::Constant || pValue->m_bRemoved ||
+            pValue->m_eOpcode == ESSAOpcode::Constant || setExecutable.count(pValue->m_pBlock) == 0) {
+            continue;
+        }
+        for (SSAValue* pOperand : pValue->m_vecOperand) {
+            auto& vecUser = pOperand->m_vecUser;
+            vecUser.erase(std::find(vecUser.begin(), vecUser.end(), pValue));
+        }
+        pValue->m_vecOperand.clear();
+        if (pValue->m_eOpcode == ESSAOpcode::Phi) {
+            auto& vecPhi = pValue->m_pBlock->m_vecPhi;
+            vecPhi.erase(std::find(vecPhi.begin(), vecPhi.end(), pValue));
+            pValue->m_pBlock->m_vecValue.insert(pValue->m_pBlock->m_vecValue.begin(), pValue);
+        }
+        pValue->m_eOpcode = ESSAOpcode::Constant;
+        pValue->m_anyConstant = lattice.m_anyValue;
+    }
+
+    // Branches on a constant become jumps
+    for (auto& pBlock : _function.m_vecBlock) {
+        SSAValue* pTerminator = pBlock->Terminator();
+        if (setExecutable.count(pBlock.get()) == 0 ||
+            (pTerminator->m_eOpcode != ESSAOpcode::Branch && pTerminator->m_eOpcode != ESSAOpcode::BranchFalse)) {
+            continue;
+        }
+        SSAValue* pCondition = pTerminator->m_vecOperand.front();
+        if (pCondition->m_eOpcode != ESSAOpcode::Constant) {
+            continue;
+        }
+        bool bTaken = pTerminator->m_eOpcode == ESSAOpcode::Branch ?
+            Object::IsTrue(pCondition->m_anyConstant) : Object::IsFalse(pCondition->m_anyConstant);
+        SSABlock* pUntaken = pBlock->m_vecSuccessor[bTaken ? 1 : 0];
+        auto& vecUser = pCondition->m_vecUser;
+        vecUser.erase(std::find(vecUser.begin(), vecUser.end(), pTerminator));
+        pTerminator->m_vecOperand.clear();
+        pTerminator->m_eOpcode = ESSAOpcode::Jump;
+        _function.RemoveEdge(pBlock.get(), pUntaken);
+    }
+    _function.RemoveUnreachableBlocks();
+}
+
+void SSAPass::PropagateCopy(SSAFunction& _function)
+{
+    bool bChanged = true;
+    while (bChanged) {
+        bChanged = false;
+        for (auto& pBlock : _function.m_vecBlock) {
+            for (SSAValue* pPhi : std::vector<SSAValue*>(pBlock->m_vecPhi)) {
+                SSAValue* pSame = nullptr;
+                bool bTrivial = true;
+                for (SSAValue* pOperand : pPhi->m_vecOperand) {
+                    if (pOperand == pPhi || pOperand == pSame) {
+                        continue;
+                    }
+                    bTrivial = pSame == nullptr;
+                    pSame = pOperand;
+                    if (bTrivial == false) {
+                        break;
+                    }
+                }
+                if (bTrivial == false || pSame == nullptr) {
+                    continue;
+                }
+                _function.ReplaceAllUses(pPhi, pSame);
+                _function.RemoveValue(pPhi);
+                bChanged = true;
+            }
+        }
+    }
+}
+
+void SSAPass::NumberValue(SSAFunction& _function)
+{
+    _function.ComputeDominator();
+    std::map<SSABlock*, std::vector<SSABlock*>> mapChildren;
+    for (auto& pBlock : _function.m_vecBlock) {
+        if (pBlock->m_pDominator) {
+            mapChildren[pBlock->m_pDominator].push_back(pBlock.get());
+        }
+    }
+
+    // Pure values live in a table scoped to the dominator subtree being visited
+    std::map<std::string, SSAValue*> mapAvailable;
+    std::vector<std::vector<std::string>> vecScopeKey;
+    std::vector<std::pair<SSABlock*, uint64>> vecStack = { { _function.m_pEntry, 0 } };
+    auto replace = [&_function](SSAValue* _pValue, SSAValue* _pExisting) {
+        _function.ReplaceAllUses(_pValue, _pExisting);
+        _function.RemoveValue(_pValue);
+    };
+
+    while (vecStack.empty() == false) {
+        auto [pBlock, next] = vecStack.back();
+        if (next == 0) {
+            vecScopeKey.emplace_back();
+            auto number = [&](SSAValue* _pValue) {
+                std::string strKey = ToExpressionKey(_pValue);
+                auto findIt = mapAvailable.find(strKey);
+                if (findIt != mapAvailable.end()) {
+                    replace(_pValue, findIt->second);
+                    return;
+                }
+                mapAvailable[strKey] = _pValue;
+                vecScopeKey.back().push_back(strKey);
+            };
+            for (SSAValue* pPhi : std::vector<SSAValue*>(pBlock->m_vecPhi)) {
+                number(pPhi);
+            }
+
+            std::map<std::string, SSAValue*> mapRead;
+            for (SSAValue* pValue : std::vector<SSAValue*>(pBlock->m_vecValue)) {
+                switch (pValue->m_eOpcode) {
+                case ESSAOpcode::Binary:
+                case ESSAOpcode::Absolute:
+                case ESSAOpcode::ReverseSign:
+                    number(pValue);
+                    continue;
+                case ESSAOpcode::GetGlobal:
+                case ESSAOpcode::GetElement:
+                    break;
+                default:
+                    if (IsPureBuiltinCall(pValue)) {
+                        break;
+                    }
+                    if (pValue->HasSideEffect()) {
+                        mapRead.clear();
+                    }
+                    continue;
+                }
+                std::string strKey = ToExpressionKey(pValue);
+                auto findIt = mapRead.find(strKey);
+                if (findIt != mapRead.end()) {
+                    replace(pValue, findIt->second);
+                }
+                else {
+                    mapRead[strKey] = pValue;
+                }
+            }
+        }
+
+        auto& vecChild = mapChildren[pBlock];
+        if (next < vecChild.size()) {
+            vecStack.back().second += 1;
+            vecStack.push_back({ vecChild[next], 0 });
+            continue;
+        }
+        for (auto& strKey : vecScopeKey.back()) {
+            mapAvailable.erase(strKey);
+        }
+        vecScopeKey.pop_back();
+        vecStack.pop_back();
+    }
+}
+
+void SSAPass::HoistInvariant(SSAFunction& _function)
+{
+    _function.ComputeDominator();
+
+    // Natural loops, innermost first so values can keep moving outward
+    std::vector<std::pair<SSABlock*, std::set<SSABlock*>>> vecLoop;
+    for (SSABlock* pHeader : _function.ReversePostOrder()) {
+        std::set<SSABlock*> setBody = { pHeader };
+        std::vector<SSABlock*> vecWork;
+        for (SSABlock* pPredecessor : pHeader->m_vecPredecessor) {
+            if (_function.Dominates(pHeader, pPredecessor)) {
+                vecWork.push_back(pPredecessor);
+            }
+        }
+        if (vecWork.empty()) {
+            continue;
+        }
+        while (vecWork.empty() == false) {
+            SSABlock* pBlock = vecWork.back();
+            vecWork.pop_back();
+            if (setBody.insert(pBlock).second) {
+                vecWork.insert(vecWork.end(), pBlock->m_vecPredecessor.begin(), pBlock->m_vecPredecessor.end());
+            }
+        }
+        vecLoop.push_back({ pHeader, std::move(setBody) });
+    }
+    std::stable_sort(vecLoop.begin(), vecLoop.end(), [](auto& _lhs, auto& _rhs) {
+        return _lhs.second.size() < _rhs.second.size();
+    });
+
+    std::vector<SSABlock*> vecOrder = _function.ReversePostOrder();
+    for (auto& [pHeader, setBody] : vecLoop) {
+        SSABlock* pPreheader = nullptr;
+        for (SSABlock* pPredecessor : pHeader->m_vecPredecessor) {
+            if (setBody.count(pPredecessor) == 0) {
+                pPreheader = pPreheader ? nullptr : pPredecessor;
+                if (pPreheader == nullptr) {
+                    break;
+                }
+            }
+        }
+        if (pPreheader == nullptr || pPreheader->m_vecSuccessor.size() != 1) {
+            continue;
+        }
+
+        bool bSideEffect = false;
+        for (SSABlock* pBlock : setBody) {
+            for (SSAValue* pValue : pBlock->m_vecValue) {
+                bSideEffect = bSideEffect || (pValue->HasSideEffect() && IsPureBuiltinCall(pValue) == false);
+            }
+        }
+        auto isInvariant = [&setBody](SSAValue* _pValue) {
+            for (SSAValue* pOperand : _pValue->m_vecOperand) {
+                if (pOperand->m_eOpcode != ESSAOpcode::Constant && setBody.count(pOperand->m_pBlock)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // Pure operations never fail, so running them once even when the loop body would not is fine
+        for (SSABlock* pBlock : vecOrder) {
+            if (setBody.count(pBlock) == 0) {
+                continue;
+            }
+            for (SSAValue* pValue : std::vector<SSAValue*>(pBlock->m_vecValue)) {
+                bool bPure = pValue->m_eOpcode == ESSAOpcode::Binary ||
+                    pValue->m_eOpcode == ESSAOpcode::Absolute ||
+                    pValue->m_eOpcode == ESSAOpcode::ReverseSign;
+                bool bRead = pValue->ReadsMemory() || IsPureBuiltinCall(pValue);
+                if ((bPure == false && (bRead == false || bSideEffect || pBlock != pHeader)) || isInvariant(pValue) == false) {
+                    continue;
+                }
+                auto& vecValue = pBlock->m_vecValue;
+                vecValue.erase(std::find(vecValue.begin(), vecValue.end(), pValue));
+                pPreheader->m_vecValue.insert(pPreheader->m_vecValue.end() - 1, pValue);
+                pValue->m_pBlock = pPreheader;
+            }
+        }
+    }
+}
+
+void SSAPass::EliminateDeadCode(SSAFunction& _function)
+{
+    std::set<SSAValue*> setLive;
+    std::vector<SSAValue*> vecWork;
+    for (auto& pBlock : _function.m_vecBlock) {
+        for (SSAValue* pValue : pBlock->m_vecValue) {
+            if (pValue->HasSideEffect() || pValue->IsTerminator()) {
+                vecWork.push_back(pValue);
+            }
+        }
+    }
+    while (vecWork.empty() == false) {
+        SSAValue* pValue = vecWork.back();
+        vecWork.pop_back();
+        if (setLive.insert(pValue).second) {
+            vecWork.insert(vecWork.end(), pValue->m_vecOperand.begin(), pValue->m_vecOperand.end());
+        }
+    }
+
+    std::vector<SSAValue*> vecDead;
+    for (auto& pBlock : _function.m_vecBlock) {
+        for (SSAValue* pValue : pBlock->m_vecPhi) {
+            if (setLive.count(pValue) == 0) {
+                vecDead.push_back(pValue);
+            }
+        }
+        for (SSAValue* pValue : pBlock->m_vecValue) {
+            if (setLive.count(pValue) == 0) {
+                vecDead.push_back(pValue);
+            }
+        }
+    }
+    for (SSAValue* pValue : vecDead) {
+        _function.RemoveValue(pValue);
+    }
+}
+
+bool SSAPass::IsPureBuiltinCall(SSAValue* _pValue)
+{
+    static const std::set<std::string> setPureBuiltin = { "length", "sqrt" };
+    if (_pValue->m_eOpcode != ESSAOpcode::Call || GeneraterMgr.m_bWholeProgram == false) {
+        return false;
+    }
+    SSAValue* pCallee = _pValue->m_vecOperand.back();
+    return pCallee->m_eOpcode == ESSAOpcode::GetGlobal &&
+        setPureBuiltin.count(pCallee->m_strName) &&
+        GeneraterMgr.m_setFunctionName.count(pCallee->m_strName) == 0 &&
+        CallGraphMgr.m_setAssigned.count(pCallee->m_strName) == 0;
+}
+
+void SSAPass::InferType(SSAFunction& _function)
+{
+    auto transfer = [](SSAValue* _pValue) -> TypeSet {
+        auto& vecOperand = _pValue->m_vecOperand;
+        switch (_pValue->m_eOpcode) {
+        case ESSAOpcode::Constant:      return TypeInference::ToTypeSet(_pValue->m_anyConstant);
+        case ESSAOpcode::Undefined:     return TypeOther;
+        case ESSAOpcode::Binary:        return TypeInference::ResultType(_pValue->m_eOperator, vecOperand[0]->m_iType, vecOperand[1]->m_iType);
+        case ESSAOpcode::Absolute:
+        case ESSAOpcode::ReverseSign:   return TypeInference::ResultType(Instruction::Absolute, vecOperand[0]->m_iType);
+        case ESSAOpcode::MakeArray:     return TypeArray;
+        case ESSAOpcode::MakeMap:       return TypeMap;
+        case ESSAOpcode::SetGlobal:
+        case ESSAOpcode::SetElement:    return vecOperand[0]->m_iType;
+        case ESSAOpcode::Phi: {
+            TypeSet result = TypeNone;
+            for (SSAValue* pOperand : vecOperand) {
+                result |= pOperand->m_iType;
+            }
+            return result;
+        }
+        default:                        return _pValue->HasResult() ? TypeAny : TypeNone;
+        }
+    };
+
+    // Types only grow, values start at TypeNone so loops settle on the join of every iteration
+    auto vecOrder = _function.ReversePostOrder();
+    bool bChanged = true;
+    while (bChanged) {
+        bChanged = false;
+        for (SSABlock* pBlock : vecOrder) {
+            for (auto* pVector : { &pBlock->m_vecPhi, &pBlock->m_vecValue }) {
+                for (SSAValue* pValue : *pVector) {
+                    TypeSet type = transfer(pValue);
+                    if (type != pValue->m_iType) {
+                        pValue->m_iType = type;
+                        bChanged = true;
+                    }
+                }
+            }
+        }
+    }
+}
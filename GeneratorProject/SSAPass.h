@@ -0,0 +1,41 @@
+#pragma once
+
+#include "TypeDefine.h"
+#include "SSA.h"
+
+// Optimizations over SSAFunction, run by SSAGenerater between Build and Lower
+class SSAPass
+{
+private:
+	SSAPass() { }
+	~SSAPass() { }
+public:
+	static SSAPass& GetInstance()
+	{
+		static thread_local SSAPass instance;
+		return instance;
+	}
+#define SSAPassMgr		SSAPass::GetInstance()
+
+public:
+	void Optimize(SSAFunction& _function);
+
+	// Sparse conditional constant propagation, folds with the Operate kernels and drops untaken branches
+	void PropagateConstant(SSAFunction& _function);
+	// Phis whose operands are all the same value are replaced by that value
+	void PropagateCopy(SSAFunction& _function);
+	// Global value numbering over the dominator tree, memory reads are only reused
+	// inside one block until the next side effect
+	void NumberValue(SSAFunction& _function);
+	// Moves loop invariant pure values to the block entering the loop, memory reads too
+	// when they sit in the header of a loop without side effects
+	void HoistInvariant(SSAFunction& _function);
+	// Removes values no side effect or terminator depends on
+	void EliminateDeadCode(SSAFunction& _function);
+	// Fills SSAValue::m_iType, phis join their operands until nothing changes
+	void InferType(SSAFunction& _function);
+
+public:
+	// Builtins that only read their arguments, a call to one is numbered like GetElement
+	static bool IsPureBuiltinCall(SSAValue* _pValue);
+};
@@ -1,4 +1,5 @@
 #include "Scanner.h"
+#include <charconv>
 
 constexpr bool Scanner::IsCharType(char c, Scanner::ECharType type) noexcept
 {
@@ -52,6 +53,15 @@ constexpr Scanner::ECharType Scanner::GetCharType(char _char) noexcept
 std::vector<CodeToken> Scanner::Scan(std::string _sourceCode)
 {
     std::vector<CodeToken> result;
+    Scan(std::move(_sourceCode), [&result](CodeToken&& _token) {
+        result.push_back(std::move(_token));
+    });
+    return result;
+}
+
+void Scanner::Scan(std::string _sourceCode, std::function<void(CodeToken&&)> _fnEmit)
+{
+    ClearLiteral();
     _sourceCode += '\0';
     m_info.iter = _sourceCode.begin();
     int32 row = 1, col = 0, baseCol = 0;
@@ -95,44 +105,56 @@ std::vector<CodeToken> Scanner::Scan(std::string _sourceCode)
 
         token.m_iRow = row;
         token.m_iCol = col;
-        result.push_back(token);
+        _fnEmit(std::move(token));
     }
-    result.push_back({ .m_eKind = EKind::EndOfToken });
-    return result;
+    _fnEmit({ .m_eKind = EKind::EndOfToken });
 }
 
 CodeToken Scanner::ScanNumberLiteral()
 {
-    EKind eKind = EKind::NumberLiteral;
-    std::string str;
+    CodeToken token = { .m_eKind = EKind::NumberLiteral };
+    const char* pBegin = &*m_info.iter;
     while (IsCharType(*m_info, Scanner::ECharType::NumberLiteral)) {
-        str += *m_info;
         m_info++;
     }
     if (*m_info == '.') {
-        str += *m_info++;
+        m_info++;
         while (IsCharType(*m_info, Scanner::ECharType::NumberLiteral)) {
-            str += *m_info++;
+            m_info++;
         }
-        eKind = EKind::FloatLiteral;
+        token.m_eKind = EKind::FloatLiteral;
+    }
+    const char* pEnd = &*m_info.iter;
+
+    std::from_chars_result result;
+    if (token.m_eKind == EKind::FloatLiteral) {
+        result = std::from_chars(pBegin, pEnd, token.m_dValue);
+    }
+    else {
+        result = std::from_chars(pBegin, pEnd, token.m_uValue);
     }
-    return { .m_strName = str, .m_eKind = eKind };
+    if (result.ec != std::errc()) {
+        std::cout << std::string(pBegin, pEnd) << " : out of range number literal.\n";
+        throw;
+    }
+    token.m_strName.assign(pBegin, pEnd);
+    return token;
 }
 
 CodeToken Scanner::ScanStringLiteral()
 {
-    std::string str;
     m_info++;
+    const char* pBegin = &*m_info.iter;
     while (IsCharType(*m_info, Scanner::ECharType::StringLiteral)) {
-        str += *m_info;
         m_info++;
     }
+    const char* pEnd = &*m_info.iter;
     if (*m_info != '\'' && *m_info != '\"') {
         std::cout << "ڿ  ڰ ϴ.";
         throw;
     }
     m_info++;
-    return { .m_strName = str, .m_eKind = EKind::StringLiteral };
+    return { .m_eKind = EKind::StringLiteral, .m_uValue = AddLiteral(std::string_view(pBegin, pEnd)) };
 }
 
 CodeToken Scanner::ScanIdentifierAndKeyword()
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <functional>
 #include "Token.h"
 
 
@@ -45,12 +46,14 @@ private:
 public:
     static Scanner& GetInstance()
     {
-        static Scanner instance;
+        static thread_local Scanner instance;
         return instance;
     }
 
 public:
     std::vector<CodeToken> Scan(std::string sourceCode);
+    // Hands every token to _fnEmit as soon as it is scanned, ends with EndOfToken
+    void Scan(std::string _sourceCode, std::function<void(CodeToken&&)> _fnEmit);
 
 private:
     constexpr bool IsCharType(char c, ECharType type) noexcept;
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include "SlotAllocator.h"
+
+namespace
+{
+    // One bit per slot
+    using SlotSet = std::vector<uint64>;
+
+    bool Test(const SlotSet& _set, uint64 _slot)
+    {
+        return (_set[_slot / 64] >> (_slot % 64)) & 1;
+    }
+
+    void Set(SlotSet& _set, uint64 _slot, bool _bValue)
+    {
+        if (_bValue) {
+            _set[_slot / 64] |= uint64(1) << (_slot % 64);
+        }
+        else {
+            _set[_slot / 64] &= ~(uint64(1) << (_slot % 64));
+        }
+    }
+
+    uint64 ToSlot(const Code& _code)
+    {
+        return std::any_cast<uint64>(_code.m_anyOperand);
+    }
+
+    bool IsSlotAccess(Instruction _instruction)
+    {
+        return _instruction == Instruction::GetLocal || _instruction == Instruction::SetLocal ||
+            _instruction == Instruction::MemoLoad || _instruction == Instruction::MemoStore;
+    }
+}
+
+void SlotAllocator::Allocate(std::vector<Code>& _vecCode, const std::map<std::string, uint64>& _mapFunctionTable)
+{
+    m_mapFrameSize.clear();
+    std::map<uint64, std::string> mapEntryTable;
+    for (auto& [name, address] : _mapFunctionTable) {
+        mapEntryTable[address] = name;
+    }
+    for (auto it = mapEntryTable.begin(); it != mapEntryTable.end(); ++it) {
+        uint64 end = std::next(it) == mapEntryTable.end() ? _vecCode.size() : std::next(it)->first;
+        if (it->first < end && _vecCode[it->first].m_instruction == Instruction::Alloca) {
+            AllocateFunction(_vecCode, it->first, end, it->second);
+        }
+    }
+}
+
+std::string SlotAllocator::PrintReport()
+{
+    std::string strResult;
+    for (auto& [name, frameSize] : m_mapFrameSize) {
+        strResult += name + " : frame " + std::to_string(frameSize.first) + " -> " + std::to_string(frameSize.second) + "\n";
+    }
+    return strResult;
+}
+
+void SlotAllocator::AllocateFunction(std::vector<Code>& _vecCode, uint64 _begin, uint64 _end, const std::string& _strName)
+{
+    uint64 slotCount = ToSlot(_vecCode[_begin]);
+    for (uint64 i = _begin; i < _end; ++i) {
+        if (IsSlotAccess(_vecCode[i].m_instruction)) {
+            slotCount = std::max(slotCount, ToSlot(_vecCode[i]) + 1);
+        }
+    }
+    uint64 wordCount = (slotCount + 63) / 64;
+    uint64 size = _end - _begin;
+
+    // Slots each instruction reads and writes, MemoLoad reads the parameters below its slot
+    std::vector<SlotSet> vecUse(size, SlotSet(wordCount));
+    std::vector<SlotSet> vecDefine(size, SlotSet(wordCount));
+    SlotSet pinned(wordCount);
+    for (uint64 i = 0; i < size; ++i) {
+        const Code& code = _vecCode[_begin + i];
+        switch (code.m_instruction) {
+        case Instruction::GetLocal:
+        case Instruction::MemoStore:
+            Set(vecUse[i], ToSlot(code), true);
+            break;
+        case Instruction::SetLocal:
+            Set(vecDefine[i], ToSlot(code), true);
+            break;
+        case Instruction::MemoLoad:
+            // The operand doubles as the parameter count, the parameters and the key slot keep their numbers
+            for (uint64 slot = 0; slot < ToSlot(code); ++slot) {
+                Set(vecUse[i], slot, true);
+            }
+            Set(vecDefine[i], ToSlot(code), true);
+            for (uint64 slot = 0; slot <= ToSlot(code); ++slot) {
+                Set(pinned, slot, true);
+            }
+            break;
+        }
+    }
+
+    // Backward liveness to a fixpoint, jumps never leave the function
+    auto successors = [&](uint64 _index, uint64(&_result)[2]) -> uint64 {
+        const Code& code = _vecCode[_begin + _index];
+        switch (code.m_instruction) {
+        case Instruction::Return:
+        case Instruction::Exit:
+            return 0;
+        case Instruction::Jump:
+            _result[0] = ToSlot(code) - _begin;
+            return 1;
+        case Instruction::ConditionJump:
+        case Instruction::LoopJump:
+        case Instruction::LogicalOr:
+        case Instruction::LogicalAnd:
+            _result[0] = ToSlot(code) - _begin;
+            _result[1] = _index + 1;
+            return 2;
+        }
+        _result[0] = _index + 1;
+        return 1;
+    };
+    std::vector<SlotSet> vecLiveIn(size + 1, SlotSet(wordCount));
+    std::vector<SlotSet> vecLiveOut(size, SlotSet(wordCount));
+    bool bChanged = true;
+    while (bChanged) {
+        bChanged = false;
+        for (uint64 i = size; i > 0; --i) {
+            uint64 index = i - 1;
+            uint64 vecSuccessor[2];
+            uint64 successorCount = successors(index, vecSuccessor);
+            SlotSet& liveOut = vecLiveOut[index];
+            for (uint64 s = 0; s < successorCount; ++s) {
+                uint64 successor = std::min(vecSuccessor[s], size);
+                for (uint64 w = 0; w < wordCount; ++w) {
+                    liveOut[w] |= vecLiveIn[successor][w];
+                }
+            }
+            for (uint64 w = 0; w < wordCount; ++w) {
+                uint64 liveIn = vecUse[index][w] | (liveOut[w] & ~vecDefine[index][w]);
+                if (liveIn != vecLiveIn[index][w]) {
+                    vecLiveIn[index][w] = liveIn;
+                    bChanged = true;
+                }
+            }
+        }
+    }
+
+    // Live on entry are parameters or reads of the empty value Alloca leaves, both stay where they are
+    for (uint64 w = 0; w < wordCount; ++w) {
+        pinned[w] |= vecLiveIn[0][w];
+    }
+    // A slot written while another is live may not share its number
+    std::vector<SlotSet> vecInterfere(slotCount, SlotSet(wordCount));
+    for (uint64 i = 0; i < size; ++i) {
+        const Code& code = _vecCode[_begin + i];
+        if (code.m_instruction != Instruction::SetLocal && code.m_instruction != Instruction::MemoLoad) {
+            continue;
+        }
+        uint64 slot = ToSlot(code);
+        for (uint64 other = 0; other < slotCount; ++other) {
+            if (other != slot && Test(vecLiveOut[i], other)) {
+                Set(vecInterfere[slot], other, true);
+                Set(vecInterfere[other], slot, true);
+            }
+        }
+    }
+
+    // Pinned slots keep their number, the rest take the lowest number no neighbour holds, in order of first use
+    std::vector<uint64> vecColor(slotCount, SIZE_MAX);
+    std::vector<bool> vecUsed(slotCount);
+    for (uint64 slot = 0; slot < slotCount; ++slot) {
+        if (Test(pinned, slot)) {
+            vecColor[slot] = slot;
+        }
+    }
+    for (uint64 i = 0; i < size; ++i) {
+        const Code& code = _vecCode[_begin + i];
+        if (IsSlotAccess(code.m_instruction) == false || vecColor[ToSlot(code)] != SIZE_MAX) {
+            continue;
+        }
+        uint64 slot = ToSlot(code);
+        std::vector<bool> vecTaken(slotCount);
+        for (uint64 other = 0; other < slotCount; ++other) {
+            if (vecColor[other] != SIZE_MAX && Test(vecInterfere[slot], other)) {
+                vecTaken[vecColor[other]] = true;
+            }
+        }
+        vecColor[slot] = std::find(vecTaken.begin(), vecTaken.end(), false) - vecTaken.begin();
+    }
+
+    for (uint64 i = _begin; i < _end; ++i) {
+        if (IsSlotAccess(_vecCode[i].m_instruction)) {
+            _vecCode[i].m_anyOperand = vecColor[ToSlot(_vecCode[i])];
+        }
+    }
+    uint64 frameSize = 0;
+    for (uint64 slot = 0; slot < slotCount; ++slot) {
+        if (vecColor[slot] != SIZE_MAX) {
+            frameSize = std::max(frameSize, vecColor[slot] + 1);
+        }
+    }
+    m_mapFrameSize[_strName] = { ToSlot(_vecCode[_begin]), frameSize };
+    _vecCode[_begin].m_anyOperand = frameSize;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <string>
+#include "TypeDefine.h"
+#include "Code.h"
+
+// Renumbers the local slots of each function after Peephole so locals that are never live
+// at the same time share a slot, Alloca is patched to the smaller frame
+class SlotAllocator
+{
+private:
+	SlotAllocator() { }
+	~SlotAllocator() { }
+public:
+	static SlotAllocator& GetInstance()
+	{
+		static thread_local SlotAllocator instance;
+		return instance;
+	}
+#define SlotAllocatorMgr		SlotAllocator::GetInstance()
+
+public:
+	void Allocate(std::vector<Code>& _vecCode, const std::map<std::string, uint64>& _mapFunctionTable);
+	std::string PrintReport();
+
+private:
+	// Code of one function is [_begin, _end), its Alloca first
+	void AllocateFunction(std::vector<Code>& _vecCode, uint64 _begin, uint64 _end, const std::string& _strName);
+
+public:
+	// Function name -> slots its frame took before and after the last Allocate
+	std::map<std::string, std::pair<uint64, uint64>> m_mapFrameSize;
+};
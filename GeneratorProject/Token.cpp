@@ -1,4 +1,6 @@
 #include "Token.h"
+#include <deque>
+#include <mutex>
 #include <iomanip>
 
 #pragma region   ̺
@@ -19,6 +21,17 @@ static std::map<EKind, std::string> StringTable =
 };
 #pragma endregion
 
+// deque keeps handed out references valid, the lock lets the pipelined parser read while the scanner appends
+struct LiteralPool
+{
+	std::deque<std::string> m_dequeLiteral;
+	std::map<std::string, uint64, std::less<>> m_mapIndex;
+	std::mutex m_mutex;
+};
+
+static thread_local LiteralPool OwnLiteralPool;
+static thread_local LiteralPool* SharedLiteralPool = &OwnLiteralPool;
+
 const EKind ToKind(const std::string& _str) noexcept
 {
 	if (KindTable.count(_str)) {
@@ -42,5 +55,47 @@ std::string ToKindString(CodeToken& _token)
 
 std::string ToTokenString(CodeToken& _token)
 {
+	if (_token.m_eKind == EKind::StringLiteral) {
+		return ToLiteral(_token.m_uValue);
+	}
 	return _token.m_strName;
+}
+
+uint64 AddLiteral(std::string_view _str)
+{
+	LiteralPool& pool = *SharedLiteralPool;
+	std::lock_guard<std::mutex> lock(pool.m_mutex);
+	auto findIt = pool.m_mapIndex.find(_str);
+	if (findIt != pool.m_mapIndex.end()) {
+		return findIt->second;
+	}
+	uint64 index = pool.m_dequeLiteral.size();
+	pool.m_dequeLiteral.emplace_back(_str);
+	pool.m_mapIndex.emplace(pool.m_dequeLiteral.back(), index);
+	return index;
+}
+
+const std::string& ToLiteral(uint64 _index)
+{
+	LiteralPool& pool = *SharedLiteralPool;
+	std::lock_guard<std::mutex> lock(pool.m_mutex);
+	return pool.m_dequeLiteral[_index];
+}
+
+void ClearLiteral()
+{
+	LiteralPool& pool = *SharedLiteralPool;
+	std::lock_guard<std::mutex> lock(pool.m_mutex);
+	pool.m_dequeLiteral.clear();
+	pool.m_mapIndex.clear();
+}
+
+LiteralPool* CurrentLiteralPool()
+{
+	return SharedLiteralPool;
+}
+
+void ShareLiteralPool(LiteralPool* _pPool)
+{
+	SharedLiteralPool = _pPool;
 }
\ No newline at end of file
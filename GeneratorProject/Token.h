@@ -1,8 +1,10 @@
 #pragma once
 
 #include <map>
+#include <vector>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include "TypeDefine.h"
 
 enum class EKind
@@ -17,10 +19,24 @@ struct CodeToken
 	std::string m_strName;
 	int32 m_iRow, m_iCol;
 	EKind m_eKind = EKind::Unknown;
+	// Scanner converts literals up front
+	// NumberLiteral : value, FloatLiteral : m_dValue, StringLiteral : literal pool index
+	uint64 m_uValue = 0;
+	float64 m_dValue = 0.0;
 };
 
 const EKind ToKind(const std::string& _str) noexcept;
 const std::string ToString(EKind _kind) noexcept;
 
+// String literal pool (one copy per distinct literal per scan)
+uint64 AddLiteral(std::string_view _str);
+const std::string& ToLiteral(uint64 _index);
+void ClearLiteral();
+// Every thread scans into and parses from a pool of its own,
+// the pipeline hands the one of the compiling thread to its scanner and parser threads
+struct LiteralPool;
+LiteralPool* CurrentLiteralPool();
+void ShareLiteralPool(LiteralPool* _pPool);
+
 std::string ToKindString(CodeToken& _token);
 std::string ToTokenString(CodeToken& _token);
\ No newline at end of file
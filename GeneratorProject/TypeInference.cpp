@@ -0,0 +1,310 @@
+#include <cassert>
+#include "TypeInference.h"
+#include "Optimizer.h"
+#include "Object.h"
+
+void TypeInference::Clear()
+{
+    m_mapType.clear();
+}
+
+void TypeInference::Analyze(std::shared_ptr<Function> _pFunction)
+{
+    m_state = TypeState();
+    m_state.m_listScope.emplace_front();
+    m_vecLoop.clear();
+    for (auto& strParameter : _pFunction->m_vecParameter) {
+        m_state.m_listScope.front()[strParameter] = TypeAny;
+    }
+    VisitBlock(_pFunction->m_vecBlock);
+}
+
+TypeSet TypeInference::TypeOf(const Expression* _pExpression) const
+{
+    auto findIt = m_mapType.find(_pExpression);
+    if (findIt == m_mapType.end()) {
+        return TypeAny;
+    }
+    return findIt->second;
+}
+
+TypeSet TypeInference::ToTypeSet(const std::any& _anyValue)
+{
+    if (Object::IsNull(_anyValue))      { return TypeNull; }
+    if (Object::IsBoolean(_anyValue))   { return TypeBoolean; }
+    if (Object::IsNumber(_anyValue))    { return TypeNumber; }
+    if (Object::IsFloat(_anyValue))     { return TypeFloat; }
+    if (Object::IsString(_anyValue))    { return TypeString; }
+    if (Object::IsArray(_anyValue))     { return TypeArray; }
+    if (Object::IsMap(_anyValue))       { return TypeMap; }
+    return TypeOther;
+}
+
+TypeSet TypeInference::ResultType(EOperator _eOperator, TypeSet _lhs, TypeSet _rhs)
+{
+    if (_eOperator >= EOperator::Equal) {
+        return _lhs == TypeNone || _rhs == TypeNone ? TypeNone : TypeBoolean;
+    }
+    // Same cases as the kernels in Operator.cpp, anything else comes out as 0.0
+    TypeSet result = TypeNone;
+    for (TypeSet lhs = _lhs; lhs != TypeNone; lhs &= lhs - 1) {
+        for (TypeSet rhs = _rhs; rhs != TypeNone; rhs &= rhs - 1) {
+            TypeSet l = lhs & (~lhs + 1);
+            TypeSet r = rhs & (~rhs + 1);
+            if (l == TypeNumber && r == TypeNumber) {
+                result |= TypeNumber;
+            }
+            else if (l == TypeString && ((r == TypeString && _eOperator == EOperator::Add) ||
+                (r == TypeNumber && _eOperator == EOperator::Multiply))) {
+                result |= TypeString;
+            }
+            else {
+                result |= TypeFloat;
+            }
+        }
+    }
+    return result;
+}
+
+TypeSet TypeInference::ResultType(Instruction _instruction, TypeSet _sub)
+{
+    // Absolute and ReverseSign keep a Number and turn anything else into 0.0
+    TypeSet result = _sub & TypeNumber;
+    if (_sub & ~TypeNumber) {
+        result |= TypeFloat;
+    }
+    return result;
+}
+
+Instruction TypeInference::ToTypedInstruction(Instruction _instruction, TypeSet _lhs, TypeSet _rhs)
+{
+    static const std::map<Instruction, Instruction> mapNumberTable = {
+        { Instruction::Add,             Instruction::AddU64 },
+        { Instruction::Subtract,        Instruction::SubtractU64 },
+        { Instruction::Multiply,        Instruction::MultiplyU64 },
+        { Instruction::Equal,           Instruction::EqualU64 },
+        { Instruction::NotEqual,        Instruction::NotEqualU64 },
+        { Instruction::LessThan,        Instruction::LessThanU64 },
+        { Instruction::GreaterThan,     Instruction::GreaterThanU64 },
+        { Instruction::LessOrEqual,     Instruction::LessOrEqualU64 },
+        { Instruction::GreaterOrEqual,  Instruction::GreaterOrEqualU64 },
+    };
+    if (_lhs == TypeNumber && _rhs == TypeNumber && mapNumberTable.count(_instruction)) {
+        return mapNumberTable.at(_instruction);
+    }
+    if (_instruction == Instruction::Add && _lhs == TypeString && _rhs == TypeString) {
+        return Instruction::ConcatString;
+    }
+    if (_lhs == TypeArray && _rhs == TypeNumber) {
+        if (_instruction == Instruction::GetElement) {
+            return Instruction::GetElementArrayU64;
+        }
+        if (_instruction == Instruction::SetElement) {
+            return Instruction::SetElementArrayU64;
+        }
+    }
+    return _instruction;
+}
+
+void TypeInference::Join(TypeState& _state, const TypeState& _other)
+{
+    if (_other.m_bReachable == false) {
+        return;
+    }
+    if (_state.m_bReachable == false) {
+        _state = _other;
+        return;
+    }
+    // Both come from the same point with balanced scopes, so the scopes line up
+    assert(_state.m_listScope.size() == _other.m_listScope.size());
+    auto otherIt = _other.m_listScope.begin();
+    for (auto& scope : _state.m_listScope) {
+        for (auto& [name, type] : scope) {
+            auto findIt = otherIt->find(name);
+            type |= findIt == otherIt->end() ? TypeAny : findIt->second;
+        }
+        ++otherIt;
+    }
+}
+
+void TypeInference::JoinLoopExit(TypeState LoopState::* _pExit)
+{
+    LoopState& loopState = m_vecLoop.back();
+    TypeState state = m_state;
+    while (state.m_listScope.size() > loopState.m_iDepth) {
+        state.m_listScope.pop_front();
+    }
+    Join(loopState.*_pExit, state);
+}
+
+bool TypeInference::IsEqual(const TypeState& _lhs, const TypeState& _rhs)
+{
+    return _lhs.m_bReachable == _rhs.m_bReachable && _lhs.m_listScope == _rhs.m_listScope;
+}
+
+void TypeInference::VisitBlock(const std::vector<std::shared_ptr<Statement>>& _vecBlock)
+{
+    m_state.m_listScope.emplace_front();
+    for (auto& pNode : _vecBlock) {
+        // Code after Return/Break/Continue never runs, its expressions stay TypeAny
+        if (m_state.m_bReachable == false) {
+            break;
+        }
+        VisitStatement(pNode);
+    }
+    m_state.m_listScope.pop_front();
+}
+
+void TypeInference::VisitStatement(const std::shared_ptr<Statement>& _pStatement)
+{
+    if (auto pVariable = std::dynamic_pointer_cast<Variable>(_pStatement)) {
+        TypeSet type = pVariable->m_pExpression ? VisitExpression(pVariable->m_pExpression) : TypeAny;
+        m_state.m_listScope.front()[pVariable->m_strName] = type;
+    }
+    else if (auto pExpression = std::dynamic_pointer_cast<ExpressionStatement>(_pStatement)) {
+        VisitExpression(pExpression->m_pExpression);
+    }
+    else if (auto pReturn = std::dynamic_pointer_cast<Return>(_pStatement)) {
+        VisitExpression(pReturn->m_pExpression);
+        m_state.m_bReachable = false;
+    }
+    else if (auto pPrint = std::dynamic_pointer_cast<Print>(_pStatement)) {
+        for (uint64 i = pPrint->m_vecArgument.size(); i > 0; --i) {
+            VisitExpression(pPrint->m_vecArgument[i - 1]);
+        }
+    }
+    else if (auto pIf = std::dynamic_pointer_cast<If>(_pStatement)) {
+        // Keeps the scopes even when no branch falls through, the enclosing block still pops them
+        TypeState result = { false, m_state.m_listScope };
+        for (uint64 i = 0; i < pIf->m_vecCondition.size(); ++i) {
+            VisitExpression(pIf->m_vecCondition[i]);
+            TypeState conditionState = m_state;
+            VisitBlock(pIf->m_vecBlocks[i]);
+            Join(result, m_state);
+            m_state = std::move(conditionState);
+        }
+        VisitBlock(pIf->m_vecElseBlock);
+        Join(result, m_state);
+        m_state = std::move(result);
+    }
+    else if (auto pFor = std::dynamic_pointer_cast<For>(_pStatement)) {
+        m_state.m_listScope.emplace_front();
+        VisitStatement(pFor->m_pVariable);
+        // The condition runs at the loop head, reached from the entry and from the end of every iteration
+        TypeState headState = m_state;
+        TypeState exitState;
+        LoopState loopState;
+        while (true) {
+            m_state = headState;
+            VisitExpression(pFor->m_pCondition);
+            exitState = m_state;
+            m_vecLoop.emplace_back();
+            m_vecLoop.back().m_iDepth = m_state.m_listScope.size();
+            VisitBlock(pFor->m_vecBlock);
+            loopState = std::move(m_vecLoop.back());
+            m_vecLoop.pop_back();
+            Join(m_state, loopState.m_continueState);
+            if (m_state.m_bReachable) {
+                VisitExpression(pFor->m_pExpression);
+            }
+            TypeState nextState = headState;
+            Join(nextState, m_state);
+            if (IsEqual(nextState, headState)) {
+                break;
+            }
+            headState = std::move(nextState);
+        }
+        m_state = std::move(exitState);
+        Join(m_state, loopState.m_breakState);
+        m_state.m_listScope.pop_front();
+    }
+    else if (std::dynamic_pointer_cast<Break>(_pStatement)) {
+        JoinLoopExit(&LoopState::m_breakState);
+        m_state.m_bReachable = false;
+    }
+    else if (std::dynamic_pointer_cast<Continue>(_pStatement)) {
+        JoinLoopExit(&LoopState::m_continueState);
+        m_state.m_bReachable = false;
+    }
+}
+
+TypeSet TypeInference::VisitExpression(const std::shared_ptr<Expression>& _pExpression)
+{
+    // Children are visited in the order Generate evaluates them, assignments inside expressions update the state
+    TypeSet result = TypeAny;
+    if (auto pGetVariable = std::dynamic_pointer_cast<GetVariable>(_pExpression)) {
+        TypeSet* pType = FindVariable(pGetVariable->m_strName);
+        result = pType ? *pType : TypeAny;
+    }
+    else if (auto pSetVariable = std::dynamic_pointer_cast<SetVariable>(_pExpression)) {
+        result = VisitExpression(pSetVariable->m_pValue);
+        if (TypeSet* pType = FindVariable(pSetVariable->m_strName)) {
+            *pType = result;
+        }
+    }
+    else if (Optimizer::IsLiteral(_pExpression)) {
+        result = ToTypeSet(_pExpression->Interpret());
+    }
+    else if (auto pArithmetic = std::dynamic_pointer_cast<Arithmetic>(_pExpression)) {
+        TypeSet lhs = VisitExpression(pArithmetic->m_pLhs);
+        TypeSet rhs = VisitExpression(pArithmetic->m_pRhs);
+        result = ResultType(ToOperator(pArithmetic->m_eKind), lhs, rhs);
+    }
+    else if (auto pRelational = std::dynamic_pointer_cast<Relational>(_pExpression)) {
+        VisitExpression(pRelational->m_pLhs);
+        VisitExpression(pRelational->m_pRhs);
+        result = TypeBoolean;
+    }
+    else if (auto pUnary = std::dynamic_pointer_cast<Unary>(_pExpression)) {
+        result = ResultType(Instruction::Absolute, VisitExpression(pUnary->m_pSub));
+    }
+    else if (std::dynamic_pointer_cast<Or>(_pExpression) || std::dynamic_pointer_cast<And>(_pExpression)) {
+        // The right side may not run, the value is whichever side ended it
+        auto pOr = std::dynamic_pointer_cast<Or>(_pExpression);
+        auto pAnd = std::dynamic_pointer_cast<And>(_pExpression);
+        result = VisitExpression(pOr ? pOr->m_pLhs : pAnd->m_pLhs);
+        TypeState lhsState = m_state;
+        result |= VisitExpression(pOr ? pOr->m_pRhs : pAnd->m_pRhs);
+        Join(m_state, lhsState);
+    }
+    else if (auto pCall = std::dynamic_pointer_cast<Call>(_pExpression)) {
+        for (uint64 i = pCall->m_vecArgument.size(); i > 0; --i) {
+            VisitExpression(pCall->m_vecArgument[i - 1]);
+        }
+        VisitExpression(pCall->m_pSub);
+    }
+    else if (auto pGetElement = std::dynamic_pointer_cast<GetElement>(_pExpression)) {
+        VisitExpression(pGetElement->m_pSub);
+        VisitExpression(pGetElement->m_pIndex);
+    }
+    else if (auto pSetElement = std::dynamic_pointer_cast<SetElement>(_pExpression)) {
+        result = VisitExpression(pSetElement->m_pValue);
+        VisitExpression(pSetElement->m_pSub);
+        VisitExpression(pSetElement->m_pIndex);
+    }
+    else if (auto pArray = std::dynamic_pointer_cast<ArrayLiteral>(_pExpression)) {
+        for (uint64 i = pArray->m_vecValue.size(); i > 0; --i) {
+            VisitExpression(pArray->m_vecValue[i - 1]);
+        }
+        result = TypeArray;
+    }
+    else if (auto pMap = std::dynamic_pointer_cast<MapLiteral>(_pExpression)) {
+        for (auto& [key, pValue] : pMap->m_mapValue) {
+            VisitExpression(pValue);
+        }
+        result = TypeMap;
+    }
+    m_mapType[_pExpression.get()] |= result;
+    return result;
+}
+
+TypeSet* TypeInference::FindVariable(const std::string& _strName)
+{
+    for (auto& scope : m_state.m_listScope) {
+        auto findIt = scope.find(_strName);
+        if (findIt != scope.end()) {
+            return &findIt->second;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <any>
+#include <map>
+#include <list>
+#include <vector>
+#include <string>
+#include <memory>
+#include "TypeDefine.h"
+#include "Operator.h"
+#include "Code.h"
+#include "Node.h"
+
+// Bit per kind of value an expression may produce, a single bit is a proven type
+using TypeSet = uint16;
+
+enum ETypeSet : TypeSet
+{
+	TypeNone	= 0,
+	TypeNull	= 1 << 0,
+	TypeBoolean	= 1 << 1,
+	TypeNumber	= 1 << 2,
+	TypeFloat	= 1 << 3,
+	TypeString	= 1 << 4,
+	TypeArray	= 1 << 5,
+	TypeMap		= 1 << 6,
+	TypeOther	= 1 << 7,	// functions, builtins, class instances and the empty slot Alloca leaves
+	TypeAny		= 0xFF,
+};
+
+// Flow sensitive type inference over the syntax tree of each Function,
+// Generate asks it for operand types to pick the typed opcodes
+class TypeInference
+{
+private:
+	TypeInference() { }
+	~TypeInference() { }
+public:
+	static TypeInference& GetInstance()
+	{
+		static thread_local TypeInference instance;
+		return instance;
+	}
+#define TypeInferenceMgr		TypeInference::GetInstance()
+
+public:
+	void Clear();
+	void Analyze(std::shared_ptr<Function> _pFunction);
+	// TypeAny for expressions Analyze has not reached
+	TypeSet TypeOf(const Expression* _pExpression) const;
+
+public:
+	static TypeSet ToTypeSet(const std::any& _anyValue);
+	// Result of Operate and of the Absolute/ReverseSign instructions for the given operand types
+	static TypeSet ResultType(EOperator _eOperator, TypeSet _lhs, TypeSet _rhs);
+	static TypeSet ResultType(Instruction _instruction, TypeSet _sub);
+	// Typed variant of a generic instruction when the operand types allow it, the instruction itself otherwise
+	static Instruction ToTypedInstruction(Instruction _instruction, TypeSet _lhs, TypeSet _rhs);
+
+private:
+	// Variables in scope, innermost first, unreachable after Return/Break/Continue
+	struct TypeState
+	{
+	public:
+		bool m_bReachable = true;
+		std::list<std::map<std::string, TypeSet>> m_listScope;
+	};
+
+	struct LoopState
+	{
+	public:
+		TypeState m_continueState = { false };
+		TypeState m_breakState = { false };
+		// Scopes outside the loop body, Break/Continue drop the deeper ones before they join
+		uint64 m_iDepth = 0;
+	};
+
+	// Both states must have the same scopes
+	static void Join(TypeState& _state, const TypeState& _other);
+	// Joins the state into the exit of the innermost loop, trimmed to the scopes outside its body
+	void JoinLoopExit(TypeState LoopState::* _pExit);
+	static bool IsEqual(const TypeState& _lhs, const TypeState& _rhs);
+
+	void VisitBlock(const std::vector<std::shared_ptr<Statement>>& _vecBlock);
+	void VisitStatement(const std::shared_ptr<Statement>& _pStatement);
+	TypeSet VisitExpression(const std::shared_ptr<Expression>& _pExpression);
+	TypeSet* FindVariable(const std::string& _strName);
+
+private:
+	std::map<const Expression*, TypeSet> m_mapType;
+	TypeState m_state;
+	std::vector<LoopState> m_vecLoop;
+};
@@ -0,0 +1,18 @@
+function h(a) {
+    return a;
+}
+
+function f(x) {
+    return h(x, 2);
+}
+
+function g(a, b) {
+    return a;
+}
+
+function main() {
+    print f(1);
+    print h(3, 4, 5);
+    print g(6);
+    printline;
+}
@@ -0,0 +1,24 @@
+function twice(x) {
+    return x * 2;
+}
+function thrice(x) {
+    return x * 3;
+}
+function root(x) {
+    return sqrt(x);
+}
+function useTwice(x) {
+    return twice(x);
+}
+function main() {
+    printline sqrt(16);
+    sqrt = twice;
+    printline sqrt(4);
+    printline root(9);
+    var a = [1, 2];
+    length = twice;
+    printline length(5);
+    printline useTwice(2);
+    twice = thrice;
+    printline useTwice(2);
+}
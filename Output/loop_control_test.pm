@@ -0,0 +1,54 @@
+function main() {
+    for i = 0, i < 3, i = i + 1 {
+        if (i == 1) {
+            var a = 2;
+            if (a) {
+                continue;
+            }
+        }
+        print i;
+        continue;
+    }
+    printline;
+
+    for i = 0, i < 4, i = i + 1 {
+        if (i == 1) {
+            var e = 2;
+            if (e == 2) {
+                continue;
+            }
+        }
+        print i;
+        continue;
+    }
+    printline;
+
+    var total = 0;
+    for i = 0, i < 6, i = i + 1 {
+        var b = i * 2;
+        if (i == 4) {
+            if (b > 0) {
+                var c = b;
+                break;
+            }
+        }
+        for j = 0, j < 3, j = j + 1 {
+            if (j == 1) {
+                continue;
+            }
+            if (j == 2) {
+                var d = j;
+                if (d > i) {
+                    break;
+                }
+                continue;
+            }
+            total = total + j + b;
+        }
+        if (b == 2) {
+            continue;
+        }
+        total = total + 1;
+    }
+    printline total;
+}
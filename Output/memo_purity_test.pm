@@ -0,0 +1,24 @@
+function noisy(x) {
+    print "side";
+    return x + 1;
+}
+function twice(x) {
+    return x * 2;
+}
+memo function apply(f, x) {
+    return f(x);
+}
+memo function local(x) {
+    var g = noisy;
+    return g(x);
+}
+function main() {
+    print apply(noisy, 1);
+    print " ";
+    printline apply(noisy, 1);
+    print local(1);
+    print " ";
+    printline local(1);
+    printline apply(twice, 3);
+    printline apply(twice, 3);
+}